@@ -0,0 +1,256 @@
+// Compares the JSON and binary (codec.h) encodings of agent_status: bytes on
+// the wire, decode + apply cost through network_handle_message, and a
+// codec_encode -> codec_decode round trip. Also compares a full agent_status
+// with the agent_delta the server sends for a typical tool-use update, and
+// one batch frame with four separate messages.
+
+#include "host.h"
+#include "codec.h"
+#include "fixtures.h"
+#include "network.h"
+#include "agent.h"
+#include <stdio.h>
+#include <string.h>
+
+#define ITERATIONS 200000
+
+static Agent agents[MAX_AGENTS];
+static int agent_count = 0;
+
+// Four slots, as a server that doesn't negotiate a slot count offers
+#define BATCH_SLOTS DEFAULT_AGENT_SLOTS
+
+static void reset_agents(void) {
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        agent_free(&agents[i]);
+        agent_clear(&agents[i], i);
+    }
+    agent_count = 0;
+}
+
+// Same fields and text; the text allocations themselves differ
+static bool agent_equal(const Agent* a, const Agent* b) {
+    Agent x = *a, y = *b;
+    x.text = y.text = NULL;
+    return memcmp(&x, &y, sizeof(Agent)) == 0 &&
+           memcmp(agent_text(a), agent_text(b), sizeof(AgentText)) == 0;
+}
+
+static bool wire_string_eq(WireString a, WireString b) {
+    return a.len == b.len && memcmp(a.str, b.str, a.len) == 0;
+}
+
+static bool wire_equal(const WireMessage* a, const WireMessage* b) {
+    return a->type == b->type && a->present == b->present &&
+           wire_string_eq(a->agent, b->agent) && a->state == b->state &&
+           a->progress == b->progress && wire_string_eq(a->message, b->message) &&
+           a->context_percent == b->context_percent &&
+           wire_string_eq(a->prompt_tool_type, b->prompt_tool_type) &&
+           wire_string_eq(a->prompt_tool_detail, b->prompt_tool_detail) &&
+           wire_string_eq(a->prompt_description, b->prompt_description) &&
+           a->slot == b->slot && a->active == b->active && a->auto_edit == b->auto_edit &&
+           a->seq == b->seq;
+}
+
+static double time_handle(bool binary, const char* payload, int len) {
+    u64 start = host_now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        network_handle_message(binary, payload, len, agents, &agent_count);
+    }
+    return (double)(host_now_ns() - start) / ITERATIONS;
+}
+
+static bool run(const char* name, int with_prompt) {
+    char json[1024];
+    int json_len = (int)fixture_status_json(json, sizeof(json), 2, 42, with_prompt);
+
+    char scratch[512];
+    WireMessage msg;
+    fixture_status_wire(&msg, scratch, sizeof(scratch), 2, 42, with_prompt);
+
+    unsigned char bin[1024];
+    int bin_len = codec_encode(&msg, bin, sizeof(bin));
+    WireMessage decoded;
+    if (bin_len < 0 || !codec_decode(bin, bin_len, &decoded) || !wire_equal(&msg, &decoded)) {
+        fprintf(stderr, "%s: round trip mismatch\n", name);
+        return false;
+    }
+
+    // Both encodings must leave the agent in the same state
+    Agent from_json = {0};
+    network_handle_message(false, json, json_len, agents, &agent_count);
+    agent_copy(&from_json, &agents[2]);
+    reset_agents();
+    network_handle_message(true, (const char*)bin, bin_len, agents, &agent_count);
+    bool same = agent_equal(&from_json, &agents[2]);
+    agent_free(&from_json);
+    if (!same) {
+        fprintf(stderr, "%s: JSON and binary decode differ\n", name);
+        return false;
+    }
+
+    u64 start = host_now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        bin_len = codec_encode(&msg, bin, sizeof(bin));
+        codec_decode(bin, bin_len, &decoded);
+    }
+    double round_trip = (double)(host_now_ns() - start) / ITERATIONS;
+
+    double json_ns = time_handle(false, json, json_len);
+    double bin_ns = time_handle(true, (const char*)bin, bin_len);
+
+    printf("%-22s json %4d B %7.0f ns | binary %4d B %6.0f ns | %4.1fx smaller %5.1fx faster | round trip %4.0f ns\n",
+           name, json_len, json_ns, bin_len, bin_ns,
+           (double)json_len / bin_len, json_ns / bin_ns, round_trip);
+    return true;
+}
+
+#define DELTA_POOL 1024
+#define DELTA_BASE_SEQ 1000
+
+typedef struct {
+    char data[128];
+    int len;
+} Payload;
+
+static Payload delta_pool[DELTA_POOL];
+
+// Build DELTA_POOL consecutive deltas after a full status with DELTA_BASE_SEQ
+static void build_deltas(bool binary) {
+    for (int i = 0; i < DELTA_POOL; i++) {
+        int seq = DELTA_BASE_SEQ + 1 + i;
+        if (binary) {
+            WireMessage msg;
+            fixture_delta_wire(&msg, 2, seq);
+            delta_pool[i].len = codec_encode(&msg, (unsigned char*)delta_pool[i].data,
+                                             sizeof(delta_pool[i].data));
+        } else {
+            delta_pool[i].len = (int)fixture_delta_json(delta_pool[i].data,
+                                                        sizeof(delta_pool[i].data), 2, seq);
+        }
+    }
+}
+
+static int encode_status(bool binary, int seq, char* out, int cap) {
+    if (!binary) return (int)fixture_status_json(out, cap, 2, seq, 0);
+    char scratch[512];
+    WireMessage msg;
+    fixture_status_wire(&msg, scratch, sizeof(scratch), 2, seq, 0);
+    return codec_encode(&msg, (unsigned char*)out, cap);
+}
+
+static bool run_delta(bool binary) {
+    const char* name = binary ? "agent_delta (binary)" : "agent_delta (json)";
+    char full[1024];
+    int full_len;
+
+    // full(seq) + delta(seq + 1) must equal full(seq + 1)
+    reset_agents();
+    full_len = encode_status(binary, 42, full, sizeof(full));
+    network_handle_message(binary, full, full_len, agents, &agent_count);
+    Agent expected = {0};
+    agent_copy(&expected, &agents[2]);
+
+    reset_agents();
+    full_len = encode_status(binary, 41, full, sizeof(full));
+    network_handle_message(binary, full, full_len, agents, &agent_count);
+
+    Payload delta;
+    if (binary) {
+        WireMessage msg;
+        fixture_delta_wire(&msg, 2, 42);
+        delta.len = codec_encode(&msg, (unsigned char*)delta.data, sizeof(delta.data));
+    } else {
+        delta.len = (int)fixture_delta_json(delta.data, sizeof(delta.data), 2, 42);
+    }
+    network_handle_message(binary, delta.data, delta.len, agents, &agent_count);
+    bool same = agent_equal(&agents[2], &expected);
+    agent_free(&expected);
+    if (!same) {
+        fprintf(stderr, "%s: delta apply differs from full status\n", name);
+        return false;
+    }
+
+    // A gap in seq must be dropped (and trigger a resync), not applied
+    if (binary) {
+        WireMessage msg;
+        fixture_delta_wire(&msg, 2, 50);
+        delta.len = codec_encode(&msg, (unsigned char*)delta.data, sizeof(delta.data));
+    } else {
+        delta.len = (int)fixture_delta_json(delta.data, sizeof(delta.data), 2, 50);
+    }
+    network_handle_message(binary, delta.data, delta.len, agents, &agent_count);
+    if (agents[2].context_percent != expected.context_percent) {
+        fprintf(stderr, "%s: out-of-order delta was applied\n", name);
+        return false;
+    }
+
+    // Time in-order deltas; the full status that rebases the pool every
+    // DELTA_POOL messages is included but amortizes to nothing
+    build_deltas(binary);
+    full_len = encode_status(binary, DELTA_BASE_SEQ, full, sizeof(full));
+    u64 start = host_now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        int k = i % DELTA_POOL;
+        if (k == 0) network_handle_message(binary, full, full_len, agents, &agent_count);
+        network_handle_message(binary, delta_pool[k].data, delta_pool[k].len, agents, &agent_count);
+    }
+    double delta_ns = (double)(host_now_ns() - start) / ITERATIONS;
+    double full_ns = time_handle(binary, full, full_len);
+
+    printf("%-22s full %4d B %7.0f ns | delta  %4d B %6.0f ns | %4.1fx smaller %5.1fx faster\n",
+           name, full_len, full_ns, delta_pool[0].len, delta_ns,
+           (double)full_len / delta_pool[0].len, full_ns / delta_ns);
+    return true;
+}
+
+// Four binary agent_status entries in one batch vs four separate messages
+static bool run_batch(void) {
+    unsigned char single[BATCH_SLOTS][256];
+    int single_len[BATCH_SLOTS];
+    unsigned char batch[1024] = { WIRE_VERSION, MSG_SLOT_BATCH };
+    int batch_len = 2;
+
+    for (int s = 0; s < BATCH_SLOTS; s++) {
+        char scratch[512];
+        WireMessage msg;
+        fixture_status_wire(&msg, scratch, sizeof(scratch), s, 10 + s, 0);
+        single_len[s] = codec_encode(&msg, single[s], sizeof(single[s]));
+        // Entry lengths stay below 128, so the varint is one byte
+        batch[batch_len++] = FIELD_ENTRY;
+        batch[batch_len++] = (unsigned char)single_len[s];
+        memcpy(batch + batch_len, single[s], single_len[s]);
+        batch_len += single_len[s];
+    }
+
+    reset_agents();
+    network_handle_message(true, (const char*)batch, batch_len, agents, &agent_count);
+    for (int s = 0; s < BATCH_SLOTS; s++) {
+        if (agent_count != BATCH_SLOTS || agents[s].context_percent != 10 + s) {
+            fprintf(stderr, "batch: slot %d not applied\n", s);
+            return false;
+        }
+    }
+
+    u64 start = host_now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        for (int s = 0; s < BATCH_SLOTS; s++) {
+            network_handle_message(true, (const char*)single[s], single_len[s], agents, &agent_count);
+        }
+    }
+    double separate_ns = (double)(host_now_ns() - start) / ITERATIONS;
+    double batch_ns = time_handle(true, (const char*)batch, batch_len);
+
+    printf("%-22s 4 msgs %4d B %6.0f ns | batch  %4d B %6.0f ns | 1 frame instead of 4\n",
+           "batch of 4 (binary)", single_len[0] * BATCH_SLOTS, separate_ns, batch_len, batch_ns);
+    return true;
+}
+
+int main(void) {
+    bool ok = run("agent_status (short)", 0) &&
+              run("agent_status (prompt)", 1) &&
+              run_delta(false) &&
+              run_delta(true) &&
+              run_batch();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+// Measures the CPU side of one rendered frame (anim_bank_tick + ui_render_top +
+// ui_render_bottom) against the counting citro2d stubs in platform.c.
+// "redraw" is the share of frames main.c would actually render with no
+// input or network traffic, i.e. where an animation on screen changed
+// frame. Like main.c, the bank animates every slot; the slots start out of
+// phase, as agents spawned at different times do.
+
+#include "host.h"
+#include "ui.h"
+#include "animation.h"
+#include "creature.h"
+#include "agent.h"
+#include <stdio.h>
+#include <string.h>
+
+#define FRAMES 20000
+
+static Agent agents[MAX_AGENTS];
+static AnimBank anims;
+
+static void set_text(AgentText* text, AgentTextField field, const char* str) {
+    agent_text_set(text, field, str, (int)strlen(str));
+}
+
+static void setup_agents(int count, bool prompt) {
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        agent_clear(&agents[i], i);
+    }
+    for (int i = 0; i < count; i++) {
+        AgentText* text = agent_text_mut(&agents[i]);
+        char name[16];
+        agent_text_set(text, TEXT_NAME, name, snprintf(name, sizeof(name), "claude-%d", i));
+        agents[i].state = prompt ? STATE_WAITING : STATE_WORKING;
+        agents[i].context_percent = 20 + (i * 15) % 80;
+        agents[i].active = true;
+        if (prompt) {
+            agents[i].prompt_visible = true;
+            set_text(text, TEXT_TOOL_TYPE, "Bash");
+            set_text(text, TEXT_TOOL_DETAIL,
+                     "npm run build -- --filter=dashboard && npm test -- --coverage "
+                     "--reporter=verbose src/components/dashboard/AgentCard.test.tsx");
+            set_text(text, TEXT_DESCRIPTION, "Build the project and run the dashboard tests");
+        }
+    }
+    ui_set_party_size(count > DEFAULT_AGENT_SLOTS ? count : DEFAULT_AGENT_SLOTS);
+    anim_bank_init(&anims, MAX_AGENTS, prompt ? &anim_waiting : &anim_working);
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        anims.elapsed_ms[i] = (u32)i * 13;
+    }
+}
+
+// selected picks the party page; the last page of a big party is drawn
+static void run(const char* name, int count, bool prompt, int selected) {
+    setup_agents(count, prompt);
+    host_stats_reset();
+
+    int redraws = 0;
+    u64 start = host_now_ns();
+    for (int f = 0; f < FRAMES; f++) {
+        // Simulated 60 fps clock
+        u64 now_ms = 1000 + (u64)f * 1000 / 60;
+        if (anim_bank_tick(&anims, now_ms) & ui_visible_slots()) redraws++;
+        ui_render_top(NULL, agents, count, selected, true, &anims);
+        ui_render_bottom(NULL, agents, count, selected, NET_CONNECTED, &anims);
+    }
+    u64 elapsed = host_now_ns() - start;
+
+    printf("%-24s %8.0f ns/frame  redraw %3.0f%%  rects %5.0f  images %2.0f  parses %4.0f  glyphs %5.0f  overflows %llu\n",
+           name, (double)elapsed / FRAMES, 100.0 * redraws / FRAMES,
+           (double)host_stats.rect_draws / FRAMES,
+           (double)host_stats.image_draws / FRAMES,
+           (double)host_stats.text_parses / FRAMES,
+           (double)host_stats.glyphs_parsed / FRAMES,
+           (unsigned long long)host_stats.textbuf_overflows);
+}
+
+// Ticking a full bank of mixed, out-of-phase animations
+static void run_anim_tick(void) {
+    static const AnimDef* const defs[] = { &anim_idle, &anim_working, &anim_waiting };
+    AnimBank bank;
+    anim_bank_init(&bank, ANIM_MAX_SLOTS, &anim_idle);
+    for (int i = 0; i < ANIM_MAX_SLOTS; i++) {
+        anim_bank_set(&bank, i, defs[i % 3]);
+        bank.elapsed_ms[i] = i * 7;
+    }
+
+    int ticks = FRAMES * 10, changes = 0;
+    u64 start = host_now_ns();
+    for (int f = 0; f < ticks; f++) {
+        if (anim_bank_tick(&bank, 1000 + (u64)f * 1000 / 60)) changes++;
+    }
+    u64 elapsed = host_now_ns() - start;
+
+    char name[32];
+    snprintf(name, sizeof(name), "anim_bank_tick x%d", ANIM_MAX_SLOTS);
+    printf("%-24s %8.1f ns/call  changed %3.0f%%\n", name,
+           (double)elapsed / ticks, 100.0 * changes / ticks);
+}
+
+// Creature drawn without its sprite texture: one rect per color run
+static void run_fallback(void) {
+    const CreatureFrame* frame = creature_get_frame(SPRITE_CLAWD);
+    creature_exit();
+    host_stats_reset();
+
+    u64 start = host_now_ns();
+    for (int i = 0; i < FRAMES; i++) {
+        draw_creature(0, 0, 3, frame);
+    }
+    u64 elapsed = host_now_ns() - start;
+    creature_init();
+
+    printf("%-24s %8.0f ns/call  rects %5.0f  frame %zu B\n", "draw_creature (no tex)",
+           (double)elapsed / FRAMES, (double)host_stats.rect_draws / FRAMES,
+           sizeof(CreatureFrame));
+}
+
+static void run_wrap(void) {
+    const char* text = agent_text(&agents[0])->prompt_tool_detail;
+    char lines[WRAP_MAX_LINES][WRAP_LINE_LEN];
+    int total = 0;
+
+    u64 start = host_now_ns();
+    for (int i = 0; i < FRAMES; i++) {
+        total += ui_wrap_text(text, 0.40f, 285, lines);
+    }
+    u64 elapsed = host_now_ns() - start;
+
+    printf("%-24s %8.0f ns/call  lines %d\n", "ui_wrap_text",
+           (double)elapsed / FRAMES, total / FRAMES);
+}
+
+int main(void) {
+    ui_init();
+    run("single agent, working", 1, false, 0);
+    run("single agent, prompt", 1, true, 0);
+    run("party of 4, working", 4, false, 0);
+    run("party of 4, prompt", 4, true, 0);
+    run("party of 16, working", 16, false, 13);
+    run("party of 16, prompt", 16, true, 13);
+    run_anim_tick();
+    run_fallback();
+    run_wrap();
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        agent_free(&agents[i]);
+    }
+    ui_exit();
+    return 0;
+}
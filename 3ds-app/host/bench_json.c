@@ -0,0 +1,356 @@
+// Compares cJSON parsing of realistic server messages with the stock heap
+// allocator against the per-message arena in json_arena.c: allocations
+// per message and parse + free time. "heap" counts malloc calls; with the
+// arena it should stay at zero.
+//
+// Then times decoding the same messages into WireMessages: cJSON (arena
+// parse + json_decode_tree) against the single-pass json_decode, after
+// checking both produce the same messages.
+//
+// Last, looks up every key of objects with 10, 100 and 1000 keys: the
+// case-insensitive list walk of cJSON_GetObjectItem against
+// cJSON_GetObjectItemCaseSensitive, which indexes objects of
+// CJSON_INDEX_MIN_ITEMS or more children on first use.
+//
+// Finally, builds outgoing command frames: the old snprintf into a queue
+// slot + copy + mask into a frame, against ws_writer escaping and masking
+// straight into the frame, checking the unmasked writer output parses back
+// to the same strings.
+
+#include "host.h"
+#include "fixtures.h"
+#include "json_arena.h"
+#include "json_codec.h"
+#include "ws_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ITERATIONS 100000
+#define BATCH_SIZE 4
+
+static unsigned long long heap_calls = 0;
+
+static void* counting_malloc(size_t size) {
+    heap_calls++;
+    return malloc(size);
+}
+
+static double run_stock(const char* json, size_t len, double* mallocs) {
+    cJSON_Hooks hooks = { counting_malloc, free };
+    cJSON_InitHooks(&hooks);
+    heap_calls = 0;
+
+    u64 start = host_now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        cJSON_Delete(cJSON_ParseWithLength(json, len));
+    }
+    u64 elapsed = host_now_ns() - start;
+
+    cJSON_InitHooks(NULL);
+    *mallocs = (double)heap_calls / ITERATIONS;
+    return (double)elapsed / ITERATIONS;
+}
+
+static double run_arena(const char* json, size_t len, double* arena_allocs, double* heap_allocs) {
+    json_arena_install();
+    JsonArenaStats before = *json_arena_get_stats();
+
+    u64 start = host_now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        json_arena_release(json_arena_parse(json, len));
+    }
+    u64 elapsed = host_now_ns() - start;
+
+    const JsonArenaStats* after = json_arena_get_stats();
+    *arena_allocs = (double)(after->arena_allocs - before.arena_allocs) / ITERATIONS;
+    *heap_allocs = (double)(after->heap_allocs - before.heap_allocs) / ITERATIONS;
+    return (double)elapsed / ITERATIONS;
+}
+
+static bool run(const char* name, const char* json, size_t len) {
+    // Both allocators must produce a usable tree
+    json_arena_install();
+    cJSON* root = json_arena_parse(json, len);
+    bool ok = root && cJSON_GetObjectItem(root, "type");
+    json_arena_release(root);
+    if (!ok) {
+        fprintf(stderr, "%s: arena parse failed\n", name);
+        return false;
+    }
+
+    double mallocs, arena_allocs, heap_allocs;
+    double stock_ns = run_stock(json, len, &mallocs);
+    double arena_ns = run_arena(json, len, &arena_allocs, &heap_allocs);
+
+    printf("%-22s %5zu B | stock %6.0f ns  heap %5.1f | arena %6.0f ns  heap %4.1f  bumps %5.1f | %4.2fx faster\n",
+           name, len, stock_ns, mallocs, arena_ns, heap_allocs, arena_allocs, stock_ns / arena_ns);
+    return true;
+}
+
+static bool wire_string_equal(WireString a, WireString b) {
+    return a.len == b.len && (a.len == 0 || memcmp(a.str, b.str, a.len) == 0);
+}
+
+static bool wire_equal(const WireMessage* a, const WireMessage* b) {
+    return a->type == b->type && a->present == b->present &&
+           wire_string_equal(a->agent, b->agent) && a->state == b->state &&
+           a->progress == b->progress && wire_string_equal(a->message, b->message) &&
+           wire_string_equal(a->pending_command, b->pending_command) &&
+           a->context_percent == b->context_percent &&
+           wire_string_equal(a->prompt_tool_type, b->prompt_tool_type) &&
+           wire_string_equal(a->prompt_tool_detail, b->prompt_tool_detail) &&
+           wire_string_equal(a->prompt_description, b->prompt_description) &&
+           a->slot == b->slot && a->active == b->active && a->auto_edit == b->auto_edit &&
+           a->success == b->success && wire_string_equal(a->error, b->error) &&
+           a->seq == b->seq;
+}
+
+// Decode through cJSON the way network.c's fallback does. Returns the
+// number of messages decoded, or -1; checks each against `expect` if given.
+static int decode_tree(const char* json, size_t len, const WireMessage* expect) {
+    cJSON* root = json_arena_parse(json, len);
+    WireMessage msg;
+    int count = -1;
+    if (root && json_decode_tree(root, &msg)) {
+        count = 0;
+        if (msg.type == MSG_SLOT_BATCH) {
+            const cJSON* entry;
+            cJSON_ArrayForEach(entry, cJSON_GetObjectItemCaseSensitive(root, "messages")) {
+                if (!json_decode_tree(entry, &msg)) continue;
+                if (expect && !wire_equal(&msg, &expect[count])) count = -1;
+                if (count < 0) break;
+                count++;
+            }
+        } else if (!expect || wire_equal(&msg, expect)) {
+            count = 1;
+        } else {
+            count = -1;
+        }
+    }
+    json_arena_release(root);
+    return count;
+}
+
+// Decode with json_decode. Decoded messages are copied to out if given;
+// their strings may point into scratch, so only the last one stays valid
+// unless entries have no escapes.
+static int decode_fast(const char* json, size_t len, WireMessage* out, int cap) {
+    static char scratch[JSON_SCRATCH_SIZE];
+    WireMessage msg;
+    WireString entries;
+    if (!json_decode(json, (int)len, &msg, &entries, scratch, sizeof(scratch))) return -1;
+    if (msg.type != MSG_SLOT_BATCH) {
+        if (out) out[0] = msg;
+        return 1;
+    }
+    int pos = 0, count = 0;
+    while (json_batch_next(entries, &pos, &msg, scratch, sizeof(scratch))) {
+        if (out && count < cap) out[count] = msg;
+        count++;
+    }
+    return pos == entries.len ? count : -1;
+}
+
+static bool run_decode(const char* name, const char* json, size_t len) {
+    WireMessage fast[BATCH_SIZE];
+    int count = decode_fast(json, len, fast, BATCH_SIZE);
+    if (count < 1 || decode_tree(json, len, fast) != count) {
+        fprintf(stderr, "%s: json_decode disagrees with cJSON\n", name);
+        return false;
+    }
+
+    int decoded = 0;
+    u64 start = host_now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        decoded += decode_tree(json, len, NULL);
+    }
+    double tree_ns = (double)(host_now_ns() - start) / ITERATIONS;
+
+    start = host_now_ns();
+    for (int i = 0; i < ITERATIONS; i++) {
+        decoded += decode_fast(json, len, NULL, 0);
+    }
+    double fast_ns = (double)(host_now_ns() - start) / ITERATIONS;
+
+    printf("%-22s %5zu B | cJSON %6.0f ns | json_decode %6.0f ns  %6.1f MB/s | %5.2fx faster%s\n",
+           name, len, tree_ns, fast_ns, len / fast_ns * 1e3, tree_ns / fast_ns,
+           decoded == 2 * count * ITERATIONS ? "" : "  (mismatch)");
+    return true;
+}
+
+#define LOOKUPS     200000
+#define BUILD_ROUNDS 200
+
+static bool run_lookup(int keys) {
+    static char json[32 * 1024];
+    static char names[1000][16];
+    size_t len = (size_t)snprintf(json, sizeof(json), "{");
+    for (int k = 0; k < keys; k++) {
+        snprintf(names[k], sizeof(names[k]), "hookField%d", k);
+        len += (size_t)snprintf(json + len, sizeof(json) - len, "%s\"%s\":%d",
+                                k > 0 ? "," : "", names[k], k);
+    }
+    len += (size_t)snprintf(json + len, sizeof(json) - len, "}");
+
+    // Cost of the first case-sensitive lookup, which builds the index
+    u64 build_ns = 0;
+    for (int r = 0; r < BUILD_ROUNDS; r++) {
+        cJSON* root = cJSON_ParseWithLength(json, len);
+        u64 start = host_now_ns();
+        bool found = cJSON_GetObjectItemCaseSensitive(root, names[0]) != NULL;
+        build_ns += host_now_ns() - start;
+        cJSON_Delete(root);
+        if (!found) return false;
+    }
+
+    cJSON* root = cJSON_ParseWithLength(json, len);
+    int found = 0;
+    u64 start = host_now_ns();
+    for (int i = 0; i < LOOKUPS; i++) {
+        found += cJSON_GetObjectItem(root, names[i % keys]) != NULL;
+    }
+    double walk_ns = (double)(host_now_ns() - start) / LOOKUPS;
+
+    start = host_now_ns();
+    for (int i = 0; i < LOOKUPS; i++) {
+        found += cJSON_GetObjectItemCaseSensitive(root, names[i % keys]) != NULL;
+    }
+    double hashed_ns = (double)(host_now_ns() - start) / LOOKUPS;
+    bool indexed = root->index != NULL;
+    cJSON_Delete(root);
+
+    printf("object of %4d keys | walk (nocase) %7.1f ns | case-sensitive %5.1f ns  first %6.0f ns  %s | %6.1fx faster\n",
+           keys, walk_ns, hashed_ns, (double)build_ns / BUILD_ROUNDS,
+           indexed ? "indexed" : "walk   ", walk_ns / hashed_ns);
+    return found == 2 * LOOKUPS;
+}
+
+#define ENCODES 200000
+
+// The pre-ws_writer send path: format, copy into a queue slot, frame + mask
+static int encode_snprintf(unsigned char* frame, const char* agent, const char* command) {
+    char json[256];
+    snprintf(json, sizeof(json),
+        "{\"type\":\"command\",\"agent\":\"%s\",\"command\":\"%s\",\"slot\":0}",
+        agent, command);
+    char slot[256];
+    strcpy(slot, json);
+
+    static const unsigned char mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+    int len = (int)strlen(slot), offset = 0;
+    frame[offset++] = 0x81;
+    if (len < 126) {
+        frame[offset++] = 0x80 | len;
+    } else {
+        frame[offset++] = 0x80 | 126;
+        frame[offset++] = (len >> 8) & 0xFF;
+        frame[offset++] = len & 0xFF;
+    }
+    memcpy(frame + offset, mask, 4);
+    offset += 4;
+    for (int i = 0; i < len; i++) {
+        frame[offset++] = slot[i] ^ mask[i % 4];
+    }
+    return offset;
+}
+
+static int encode_writer(unsigned char* buf, int cap, const char* agent, const char* command,
+                         const unsigned char** frame) {
+    WsWriter w;
+    ws_writer_begin(&w, buf, cap, 0x1);
+    ws_writer_raw(&w, "{\"type\":\"command\",\"agent\":");
+    ws_writer_string(&w, agent);
+    ws_writer_raw(&w, ",\"command\":");
+    ws_writer_string(&w, command);
+    ws_writer_raw(&w, ",\"slot\":0}");
+    int len = 0;
+    return ws_writer_end(&w, frame, &len) ? len : -1;
+}
+
+// Unmask a writer frame and check it parses back to agent and command
+static bool check_frame(const unsigned char* frame, int len, const char* agent, const char* command) {
+    int at = (frame[1] & 0x7F) == 126 ? 4 : 2;
+    const unsigned char* mask = frame + at;
+    char json[4096];
+    int n = len - at - 4;
+    for (int i = 0; i < n; i++) {
+        json[i] = (char)(frame[at + 4 + i] ^ mask[i & 3]);
+    }
+    cJSON* root = cJSON_ParseWithLength(json, (size_t)n);
+    const cJSON* a = cJSON_GetObjectItemCaseSensitive(root, "agent");
+    const cJSON* c = cJSON_GetObjectItemCaseSensitive(root, "command");
+    bool ok = cJSON_IsString(a) && cJSON_IsString(c) &&
+              strcmp(a->valuestring, agent) == 0 && strcmp(c->valuestring, command) == 0;
+    cJSON_Delete(root);
+    return ok;
+}
+
+static bool run_encode(const char* name, const char* agent, const char* command) {
+    static unsigned char buf[4096];
+    const unsigned char* frame;
+    int len = encode_writer(buf, sizeof(buf), agent, command, &frame);
+    if (len < 0 || !check_frame(frame, len, agent, command)) {
+        printf("%-24s | writer frame does not round-trip\n", name);
+        return false;
+    }
+
+    unsigned int sink = 0;
+    u64 start = host_now_ns();
+    for (int i = 0; i < ENCODES; i++) {
+        sink += (unsigned int)encode_snprintf(buf, agent, command);
+    }
+    double old_ns = (double)(host_now_ns() - start) / ENCODES;
+
+    start = host_now_ns();
+    for (int i = 0; i < ENCODES; i++) {
+        sink += (unsigned int)encode_writer(buf, sizeof(buf), agent, command, &frame);
+    }
+    double writer_ns = (double)(host_now_ns() - start) / ENCODES;
+
+    printf("%-24s | snprintf + copy + mask %6.1f ns | ws_writer %6.1f ns  %4d B | %4.1fx faster%s\n",
+           name, old_ns, writer_ns, len, old_ns / writer_ns, sink ? "" : " ");
+    return true;
+}
+
+int main(void) {
+    char status[1024], prompt[1024], batch[4096];
+    size_t status_len = fixture_status_json(status, sizeof(status), 1, 42, 0);
+    size_t prompt_len = fixture_status_json(prompt, sizeof(prompt), 1, 42, 1);
+
+    // {"type":"batch","messages":[...]} of prompt-sized entries, as the
+    // server sends after a burst across the party
+    size_t batch_len = (size_t)snprintf(batch, sizeof(batch), "{\"type\":\"batch\",\"messages\":[");
+    for (int s = 0; s < BATCH_SIZE; s++) {
+        if (s > 0) batch[batch_len++] = ',';
+        batch_len += fixture_status_json(batch + batch_len, sizeof(batch) - batch_len, s, 42 + s, 1);
+    }
+    batch_len += (size_t)snprintf(batch + batch_len, sizeof(batch) - batch_len, "]}");
+
+    // An Edit prompt whose detail is full of escapes, decoded into scratch
+    static const char escaped[] =
+        "{\"type\":\"agent_status\",\"agent\":\"claude-2\",\"state\":\"waiting\","
+        "\"progress\":-1,\"message\":\"Edit: src/ui.c\",\"contextPercent\":57,"
+        "\"promptToolType\":\"Edit\",\"promptToolDetail\":\"src/ui.c\\n- printf(\\\"%d\\\\n\\\", n);"
+        "\\n+ printf(\\\"%d \\u2192 %d\\\\n\\\", n, m);\\n\\t// caf\\u00e9 \\ud83e\\udd80\","
+        "\"promptDescription\":\"Print the mapping\",\"autoEdit\":false,\"slot\":2,"
+        "\"active\":true,\"seq\":7}";
+
+    bool ok = run("agent_status (short)", status, status_len) &&
+              run("agent_status (prompt)", prompt, prompt_len) &&
+              run("batch of 4 (prompt)", batch, batch_len);
+    printf("arena high water %zu B\n", json_arena_get_stats()->high_water);
+
+    ok = ok && run_decode("agent_status (short)", status, status_len) &&
+         run_decode("agent_status (prompt)", prompt, prompt_len) &&
+         run_decode("agent_status (escaped)", escaped, sizeof(escaped) - 1) &&
+         run_decode("batch of 4 (prompt)", batch, batch_len);
+
+    cJSON_InitHooks(NULL);
+    ok = ok && run_lookup(10) && run_lookup(100) && run_lookup(1000);
+
+    ok = ok && run_encode("command (plain)", "claude-1", "/compact") &&
+         run_encode("command (escaped)", "claude-2",
+                    "fix \"ui.c\"\n\tthen run C:\\build\\make \x01" "caf\xc3\xa9");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,496 @@
+// Drives network_poll -> process_ws_frame -> parse_message with agent_status
+// bursts pushed over a loopback socket: one frame per slot, or all four slots
+// in one batch frame the way the server's coalescing window sends them.
+// Connecting is timed first: the longest single network_connect/network_poll
+// call is the worst frame stall a reconnect can cause. Each run also reports
+// heap allocations per message and the deepest stack network_poll reached.
+// Last, actions are sent in bursts at a server that only reads between
+// bursts through a small receive buffer, so the client has to carry short
+// writes and EAGAIN over to later polls; every frame must arrive whole and
+// in order. Acks for them must come back out of network_get_latency.
+// Finally the loopback answers heartbeat pings for a while, then goes
+// quiet: the time until the client drops the link is the dead-link
+// detection time. The reconnect scheduler is driven the way main.c does:
+// WiFi drops along with the connection and comes back, which must bring
+// the link back well under a second and resume the synced slots; then the
+// server goes away for good and the attempts have to back off.
+
+#include "host.h"
+#include "fixtures.h"
+#include "loopback.h"
+#include "network.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define BURSTS       20000  // multiple of every batch size
+#define BURST_SLOTS  4
+#define BURST_CYCLE  64
+#define MAX_SPINS    1000000
+#define LARGE_MESSAGES 2000
+#define ACTIONS        20000
+#define ACTION_BURST   32
+
+static Agent agents[MAX_AGENTS];
+static int agent_count = 0;
+
+static unsigned char bursts[BURST_CYCLE][BURST_SLOTS * 1024];
+static size_t burst_len[BURST_CYCLE];
+
+static void build_bursts(int with_prompt, int batched) {
+    for (int b = 0; b < BURST_CYCLE; b++) {
+        burst_len[b] = 0;
+        if (batched) {
+            char json[BURST_SLOTS * 1024];
+            size_t n = (size_t)snprintf(json, sizeof(json), "{\"type\":\"batch\",\"messages\":[");
+            for (int s = 0; s < BURST_SLOTS; s++) {
+                if (s > 0) json[n++] = ',';
+                n += fixture_status_json(json + n, sizeof(json) - n, s, b, with_prompt);
+            }
+            n += (size_t)snprintf(json + n, sizeof(json) - n, "]}");
+            burst_len[b] = fixture_ws_frame(bursts[b], sizeof(bursts[b]), 0x1, json, n);
+            continue;
+        }
+        for (int s = 0; s < BURST_SLOTS; s++) {
+            char json[1024];
+            size_t n = fixture_status_json(json, sizeof(json), s, b, with_prompt);
+            burst_len[b] += fixture_ws_frame(bursts[b] + burst_len[b],
+                                             sizeof(bursts[b]) - burst_len[b], 0x1, json, n);
+        }
+    }
+}
+
+static void print_run(const char* name, double msgs, u64 elapsed, size_t bytes,
+                      unsigned int copied, u64 allocs, size_t stack) {
+    printf("%-24s %10.0f msg/s %8.0f ns/msg %8.1f MB/s %8.1f B copied/msg %5.2f allocs/msg %6zu B stack\n",
+           name, msgs * 1e9 / elapsed, elapsed / msgs, bytes * 1e3 / elapsed,
+           copied / msgs, allocs / msgs, stack);
+}
+
+// batch: bursts written back-to-back before the client is polled, so frames
+// straddle recv() boundaries and exercise buffer compaction
+// Poll until slot 3's contextPercent reaches the marker value
+static bool wait_for_marker(const char* name, int marker) {
+    int spins = 0;
+    do {
+        network_poll(agents, &agent_count);
+        if (++spins > MAX_SPINS) {
+            fprintf(stderr, "%s: marker %d never arrived\n", name, marker);
+            return false;
+        }
+    } while (agent_count < BURST_SLOTS || agents[BURST_SLOTS - 1].context_percent != marker);
+    return true;
+}
+
+static bool run(const char* name, Loopback* lb, int with_prompt, int batch, int batched) {
+    build_bursts(with_prompt, batched);
+
+    size_t bytes = 0;
+    NetworkStats before = *network_get_stats();
+    u64 allocs = host_stats.heap_allocs;
+    host_stack_paint();
+    u64 start = host_now_ns();
+    for (int i = 0; i < BURSTS; i += batch) {
+        int b = 0;
+        for (int k = 0; k < batch; k++) {
+            b = (i + k) % BURST_CYCLE;
+            if (!loopback_send(lb, bursts[b], burst_len[b])) return false;
+            bytes += burst_len[b];
+        }
+
+        // The last frame of each burst sets slot 3's context to b
+        if (!wait_for_marker(name, b % 101)) return false;
+    }
+    u64 elapsed = host_now_ns() - start;
+    size_t stack = host_stack_used();
+    const NetworkStats* after = network_get_stats();
+
+    double msgs = (double)BURSTS * BURST_SLOTS;
+    print_run(name, msgs, elapsed, bytes, after->bytes_copied - before.bytes_copied,
+              host_stats.heap_allocs - allocs, stack);
+    return true;
+}
+
+// One large message for slot 3 split into `fragments` frames, with a ping
+// between each pair of fragments
+static bool run_fragmented(const char* name, Loopback* lb, size_t detail_len, int fragments) {
+    static char json[32 * 1024];
+    static unsigned char wire[40 * 1024];
+    static const char ping[] = "hb";
+    char pongs[256];
+
+    size_t bytes = 0;
+    NetworkStats before = *network_get_stats();
+    u64 allocs = host_stats.heap_allocs;
+    host_stack_paint();
+    u64 start = host_now_ns();
+    for (int i = 0; i < LARGE_MESSAGES; i++) {
+        size_t len = fixture_large_status_json(json, sizeof(json), BURST_SLOTS - 1, i, detail_len);
+        size_t chunk = (len + fragments - 1) / fragments;
+        size_t wire_len = 0;
+        for (int f = 0; f < fragments; f++) {
+            size_t off = f * chunk;
+            size_t n = (off + chunk < len) ? chunk : len - off;
+            wire_len += fixture_ws_fragment(wire + wire_len, sizeof(wire) - wire_len,
+                                            f == 0 ? 0x1 : 0x0, f == fragments - 1, json + off, n);
+            if (f < fragments - 1) {
+                wire_len += fixture_ws_frame(wire + wire_len, sizeof(wire) - wire_len,
+                                             0x9, ping, sizeof(ping) - 1);
+            }
+        }
+        if (!loopback_send(lb, wire, wire_len)) return false;
+        bytes += wire_len;
+
+        if (!wait_for_marker(name, i % 101)) return false;
+        while (loopback_recv(lb, pongs, sizeof(pongs)) > 0) {}
+    }
+    u64 elapsed = host_now_ns() - start;
+    size_t stack = host_stack_used();
+    const NetworkStats* after = network_get_stats();
+
+    double msgs = LARGE_MESSAGES;
+    print_run(name, msgs, elapsed, bytes, after->bytes_copied - before.bytes_copied,
+              host_stats.heap_allocs - allocs, stack);
+    return true;
+}
+
+// Check the client's frames in [*pos, len) and consume the complete ones:
+// masked text frames carrying actions for agents numbered from *next up
+static bool check_actions(const unsigned char* wire, int len, int* pos, int* next, int* frames) {
+    while (len - *pos >= 6) {
+        const unsigned char* f = wire + *pos;
+        int payload = f[1] & 0x7F;
+        if ((f[0] != 0x81 && f[0] != 0x89) || !(f[1] & 0x80) || payload >= 126) return false;
+        if (len - *pos < 6 + payload) break;
+        if (f[0] == 0x89) {  // heartbeat ping
+            *pos += 6 + payload;
+            continue;
+        }
+
+        char json[128];
+        for (int i = 0; i < payload; i++) {
+            json[i] = (char)(f[6 + i] ^ f[2 + (i & 3)]);
+        }
+        json[payload] = '\0';
+        int agent;
+        char expect[128];
+        if (sscanf(json, "{\"type\":\"action\",\"agent\":\"a%d\"", &agent) != 1) return false;
+        int n = snprintf(expect, sizeof(expect),
+                 "{\"type\":\"action\",\"agent\":\"a%d\",\"action\":\"yes\",\"slot\":0,\"id\":", agent);
+        if (agent < *next || strncmp(json, expect, n) != 0 || json[payload - 1] != '}') return false;
+        *next = agent + 1;
+        *pos += 6 + payload;
+        (*frames)++;
+    }
+    return true;
+}
+
+// Ack actions "sent" 0..ACKS-1 ms ago and check the round trips reported
+static bool run_acks(const char* name, Loopback* lb) {
+    enum { ACKS = 100 };
+    NetworkLatency before;
+    network_get_latency(&before);
+    for (int i = 0; i < ACKS; i++) {
+        char json[128];
+        unsigned char wire[160];
+        int client_ms = (int)((osGetTime() - i) & 0x7FFFFFFF);
+        size_t n = (size_t)snprintf(json, sizeof(json),
+                                    "{\"type\":\"action_ack\",\"id\":%d,\"clientMs\":%d,\"serverMs\":3}",
+                                    i, client_ms);
+        if (!loopback_send(lb, wire, fixture_ws_frame(wire, sizeof(wire), 0x1, json, n))) return false;
+    }
+
+    NetworkLatency after;
+    for (int spins = 0; spins < MAX_SPINS; spins++) {
+        network_poll(agents, &agent_count);
+        network_get_latency(&after);
+        if (after.acks - before.acks == ACKS) break;
+    }
+    printf("%-24s %6u acks  last %3d ms  p50 %3d ms  p95 %3d ms  p99 %3d ms  server %d ms\n",
+           name, after.acks - before.acks, after.last_ms, after.p50_ms, after.p95_ms,
+           after.p99_ms, after.server_ms);
+    // The window holds the last LATENCY_WINDOW acks: ages 36..99 ms and up
+    return after.acks - before.acks == ACKS && after.server_ms == 3 &&
+           after.p50_ms >= 60 && after.p95_ms >= after.p50_ms && after.p99_ms >= 96;
+}
+
+// Answer the client's pings in what it has sent; returns pongs sent
+static int answer_pings(Loopback* lb) {
+    unsigned char in[1024];
+    int len = loopback_recv(lb, in, sizeof(in));
+    int pongs = 0;
+    for (int pos = 0; len - pos >= 6;) {
+        const unsigned char* f = in + pos;
+        int payload = f[1] & 0x7F;
+        if (payload >= 126 || len - pos < 6 + payload) break;  // benchmark traffic only
+        if (f[0] == 0x89) {
+            char data[125];
+            for (int i = 0; i < payload; i++) data[i] = (char)(f[6 + i] ^ f[2 + (i & 3)]);
+            unsigned char pong[160];
+            if (!loopback_send(lb, pong, fixture_ws_frame(pong, sizeof(pong), 0xA, data, payload)))
+                return -1;
+            pongs++;
+        }
+        pos += 6 + payload;
+    }
+    return pongs;
+}
+
+static bool run_heartbeat(const char* name, Loopback* lb) {
+    // Keep the link alive on pongs alone
+    int pongs = 0;
+    u64 start = osGetTime();
+    while (osGetTime() - start < 2500) {
+        network_poll(agents, &agent_count);
+        int n = answer_pings(lb);
+        if (n < 0) return false;
+        pongs += n;
+        svcSleepThread(1000000);
+    }
+    if (!network_is_connected() || pongs == 0 || network_get_rtt() < 0) {
+        fprintf(stderr, "%s: link not kept alive (%d pongs)\n", name, pongs);
+        return false;
+    }
+
+    // Then stop answering, as a dead WiFi link would
+    u64 silent = osGetTime();
+    while (network_is_connected()) {
+        if (osGetTime() - silent > 10000) {
+            fprintf(stderr, "%s: dead link never detected\n", name);
+            return false;
+        }
+        network_poll(agents, &agent_count);
+        svcSleepThread(1000000);
+    }
+    printf("%-24s %6d pongs  rtt %d ms  dead link dropped after %llu ms\n", name, pongs,
+           network_get_rtt(), (unsigned long long)(osGetTime() - silent));
+    return network_get_stats()->heartbeat_timeouts > 0;
+}
+
+// Drive the reconnect scheduler like main.c until connected, answering the
+// upgrade when it arrives. Returns the elapsed ms, or -1 on timeout.
+static int reconnect_client(Loopback* lb, int timeout_ms) {
+    u64 start = osGetTime();
+    bool accepted = false;
+    while (!network_is_connected()) {
+        if (osGetTime() - start > (u64)timeout_ms) return -1;
+        if (network_reconnect_due()) {
+            network_connect("localhost", lb->port);
+            accepted = false;
+        }
+        if (!accepted && network_get_phase() == NET_HANDSHAKE) {
+            if (!loopback_accept(lb)) return -1;
+            accepted = true;
+        }
+        network_poll(agents, &agent_count);
+        svcSleepThread(1000000);
+    }
+    return (int)(osGetTime() - start);
+}
+
+static bool run_wifi_drop(const char* name, Loopback* lb) {
+    // A server run that supports resume, and all four slots synced at seq 100
+    loopback_drop(lb);
+    lb->epoch = 7;
+    if (reconnect_client(lb, 5000) < 0) return false;
+    for (int s = 0; s < BURST_SLOTS; s++) {
+        char json[1024];
+        unsigned char wire[1100];
+        size_t n = fixture_status_json(json, sizeof(json), s, 100, 0);
+        if (!loopback_send(lb, wire, fixture_ws_frame(wire, sizeof(wire), 0x1, json, n))) return false;
+    }
+    if (!wait_for_marker(name, 100)) return false;
+
+    // WiFi and the connection go together; nothing is tried until it's back
+    NetworkStats before = *network_get_stats();
+    host_wifi_status = 0;
+    svcSleepThread(300000000);  // long enough for the client to notice
+    loopback_drop(lb);
+    u64 down = osGetTime();
+    while (osGetTime() - down < 600) {
+        if (network_reconnect_due()) network_connect("localhost", lb->port);
+        network_poll(agents, &agent_count);
+        svcSleepThread(1000000);
+    }
+    unsigned int tried = network_get_stats()->reconnects - before.reconnects;
+    if (network_is_connected() || tried != 0) {
+        fprintf(stderr, "%s: %u attempts while WiFi was down\n", name, tried);
+        return false;
+    }
+
+    host_wifi_status = 1;
+    int ms = reconnect_client(lb, 5000);
+    unsigned int resumed = network_get_stats()->resumed_slots - before.resumed_slots;
+    const char* since = strstr(lb->request, "&epoch=7&since=100,100,100,100 ");
+    printf("%-24s back up %d ms after WiFi returned  %u slots resumed\n", name, ms, resumed);
+    if (ms < 0 || ms > 1000 || resumed != BURST_SLOTS || since == NULL) {
+        fprintf(stderr, "%s: no quick resume (request: %.80s)\n", name, lb->request);
+        return false;
+    }
+    return true;
+}
+
+// The server goes away: attempts must back off rather than spin
+static bool run_backoff(const char* name, Loopback* lb) {
+    enum { WATCH_MS = 4000 };
+    loopback_drop(lb);
+    close(lb->listen_fd);
+    lb->listen_fd = -1;
+
+    u64 start = osGetTime(), last = start;
+    int gaps[16], attempts = 0;
+    while (osGetTime() - start < WATCH_MS) {
+        if (network_reconnect_due()) {
+            if (attempts > 0 && attempts <= 16) gaps[attempts - 1] = (int)(osGetTime() - last);
+            last = osGetTime();
+            attempts++;
+            network_connect("localhost", lb->port);
+        }
+        network_poll(agents, &agent_count);
+        svcSleepThread(1000000);
+    }
+
+    printf("%-24s %d attempts in %d ms, waits", name, attempts, WATCH_MS);
+    for (int i = 0; i < attempts - 1 && i < 16; i++) printf(" %d", gaps[i]);
+    printf(" ms\n");
+    // At once, then 125-250, 250-500, 500-1000 and 1000-2000 ms
+    if (attempts < 4 || attempts > 6) return false;
+    for (int i = 1; i < attempts - 1; i++) {
+        if (gaps[i] < gaps[i - 1] / 2) return false;
+    }
+    return true;
+}
+
+// The client's end of the loopback connection: the socket whose local
+// address is the server side's peer
+static int find_client_fd(Loopback* lb) {
+    struct sockaddr_storage peer, local;
+    socklen_t peer_len = sizeof(peer);
+    if (getpeername(lb->conn_fd, (struct sockaddr*)&peer, &peer_len) != 0) return -1;
+    for (int fd = 0; fd < 256; fd++) {
+        socklen_t local_len = sizeof(local);
+        if (fd == lb->conn_fd || getsockname(fd, (struct sockaddr*)&local, &local_len) != 0) continue;
+        if (local_len == peer_len && memcmp(&local, &peer, peer_len) == 0) return fd;
+    }
+    return -1;
+}
+
+static bool run_actions(const char* name, Loopback* lb) {
+    static unsigned char wire[64 * 1024];
+
+    // Shrink both socket buffers so a burst backs up into the client's
+    // out_buf instead of disappearing into the kernel
+    int client = find_client_fd(lb);
+    int small = 2048;
+    if (client < 0) return false;
+    setsockopt(client, SOL_SOCKET, SO_SNDBUF, &small, sizeof(small));
+    setsockopt(lb->conn_fd, SOL_SOCKET, SO_RCVBUF, &small, sizeof(small));
+
+    NetworkStats before = *network_get_stats();
+    u64 send_ns = 0, worst = 0;
+    int len = 0, pos = 0, next = 0, frames = 0;
+    for (int i = 0; i < ACTIONS; i++) {
+        char agent[16];
+        snprintf(agent, sizeof(agent), "a%d", i);
+        u64 t = host_now_ns();
+        network_send_action(agent, "yes");
+        t = host_now_ns() - t;
+        send_ns += t;
+        if (t > worst) worst = t;
+        network_poll(agents, &agent_count);
+
+        // The server catches up between bursts: read until every action
+        // sent so far has arrived or been counted as dropped
+        if ((i + 1) % ACTION_BURST != 0) continue;
+        u64 deadline = host_now_ns() + 5000000000ull;
+        int dropped = (int)(network_get_stats()->send_dropped - before.send_dropped);
+        while (frames + dropped < i + 1) {
+            if (host_now_ns() > deadline || !network_is_connected()) {
+                fprintf(stderr, "%s: %d of %d actions arrived\n", name, frames, i + 1 - dropped);
+                return false;
+            }
+            network_poll(agents, &agent_count);
+            if (pos > 0) {
+                memmove(wire, wire + pos, len - pos);
+                len -= pos;
+                pos = 0;
+            }
+            len += loopback_recv(lb, wire + len, sizeof(wire) - len);
+            if (!check_actions(wire, len, &pos, &next, &frames)) {
+                fprintf(stderr, "%s: torn or reordered frame after a%d\n", name, next - 1);
+                return false;
+            }
+            dropped = (int)(network_get_stats()->send_dropped - before.send_dropped);
+        }
+    }
+    const NetworkStats* after = network_get_stats();
+
+    printf("%-24s %8.0f ns/send %8.1f us worst call %6u retried %5u dropped\n",
+           name, (double)send_ns / ACTIONS, worst / 1e3,
+           after->send_retries - before.send_retries, after->send_dropped - before.send_dropped);
+    return true;
+}
+
+// Connect through the non-blocking state machine and report the longest
+// single network_connect/network_poll call, i.e. the worst frame stall
+static bool connect_client(const char* name, Loopback* lb, const char* host) {
+    u64 start = host_now_ns();
+    bool ok = network_connect(host, lb->port);
+    u64 worst = host_now_ns() - start;
+    if (!ok) {
+        fprintf(stderr, "%s: connect failed\n", name);
+        return false;
+    }
+
+    bool accepted = false;
+    for (int spins = 0; !network_is_connected(); spins++) {
+        if (spins > MAX_SPINS || network_get_phase() == NET_IDLE) {
+            fprintf(stderr, "%s: handshake failed\n", name);
+            return false;
+        }
+        // The loopback server answers once the upgrade request is on the wire
+        if (!accepted && network_get_phase() == NET_HANDSHAKE) {
+            if (!loopback_accept(lb)) return false;
+            accepted = true;
+        }
+        u64 t = host_now_ns();
+        network_poll(agents, &agent_count);
+        t = host_now_ns() - t;
+        if (t > worst) worst = t;
+    }
+
+    printf("%-24s %10.1f us total %8.1f us worst call\n", name,
+           (host_now_ns() - start) / 1e3, worst / 1e3);
+    return true;
+}
+
+int main(void) {
+    Loopback lb;
+    if (!loopback_open(&lb) || !network_init()) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+    // By name first (resolver thread), then again from the cached address
+    if (!connect_client("connect (resolve)", &lb, "localhost")) return 1;
+    network_disconnect();
+    loopback_drop(&lb);
+    if (!connect_client("reconnect (cached)", &lb, "localhost")) return 1;
+
+    bool ok = run("agent_status (short)", &lb, 0, 1, 0) &&
+              run("agent_status (prompt)", &lb, 1, 1, 0) &&
+              run("prompt, 16-burst backlog", &lb, 1, 16, 0) &&
+              run("4-slot batch (short)", &lb, 0, 1, 1) &&
+              run("4-slot batch (prompt)", &lb, 1, 1, 1) &&
+              run_fragmented("16 KB in 4 fragments", &lb, 16 * 1024, 4) &&
+              run_actions("actions, slow reader", &lb) &&
+              run_acks("action_ack round trips", &lb) &&
+              run_heartbeat("heartbeat", &lb) &&
+              run_wifi_drop("reconnect after WiFi drop", &lb) &&
+              run_backoff("backoff, server gone", &lb);
+
+    network_exit();
+    loopback_close(&lb);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+// Render-loop stress test. A producer thread floods the client with bursts of
+// agent_status messages over loopback while the main thread runs frames
+// (network_poll + anim_bank_tick + ui_render_top/bottom), with networking inline on
+// the render thread and then on the worker thread (network_start_thread).
+// Reports median, p99 and worst frame time per burst size.
+
+#include "host.h"
+#include "fixtures.h"
+#include "loopback.h"
+#include "network.h"
+#include "agent.h"
+#include "ui.h"
+#include "animation.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BURST_ROUNDS   8
+#define BURST_GAP_MS   10
+#define MAX_BURST      1024
+#define MAX_FRAMES     200000
+#define FRAME_WAIT_NS  1000000LL   // stands in for the vblank wait
+#define SETTLE_MS      5000
+#define PARTY          DEFAULT_AGENT_SLOTS  // loopback offers no slot count
+
+static Agent agents[MAX_AGENTS];
+static int agent_count = 0;
+static AnimBank anims;
+static u64 frame_ns[MAX_FRAMES];
+
+typedef struct {
+    Loopback* lb;
+    unsigned char* wire;
+    size_t wire_len;
+    bool done;
+    bool failed;
+} Producer;
+
+static const char end_marker[] =
+    "{\"type\":\"agent_status\",\"agent\":\"end\",\"state\":\"idle\",\"slot\":3}";
+
+// Burst of `burst` messages cycling over the party
+static size_t build_burst(unsigned char* wire, size_t cap, int burst) {
+    size_t len = 0;
+    for (int i = 0; i < burst; i++) {
+        char json[1024];
+        size_t n = fixture_status_json(json, sizeof(json), i % PARTY, i, 1);
+        len += fixture_ws_frame(wire + len, cap - len, 0x1, json, n);
+    }
+    return len;
+}
+
+static void* producer_main(void* arg) {
+    Producer* p = arg;
+    for (int r = 0; r < BURST_ROUNDS; r++) {
+        if (!loopback_send(p->lb, p->wire, p->wire_len)) {
+            p->failed = true;
+            break;
+        }
+        svcSleepThread(BURST_GAP_MS * 1000000LL);
+    }
+    // Renames slot 3 once everything before it has been applied
+    unsigned char end[128];
+    size_t end_len = fixture_ws_frame(end, sizeof(end), 0x1, end_marker, sizeof(end_marker) - 1);
+    if (!p->failed && !loopback_send(p->lb, end, end_len)) p->failed = true;
+    __atomic_store_n(&p->done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static u64 run_frame(void) {
+    u64 start = host_now_ns();
+    network_poll(agents, &agent_count);
+    anim_bank_tick(&anims, osGetTime());
+    ui_render_top(NULL, agents, agent_count, 0, network_is_connected(), &anims);
+    ui_render_bottom(NULL, agents, agent_count, 0, network_get_phase(), &anims);
+    return host_now_ns() - start;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    u64 x = *(const u64*)a, y = *(const u64*)b;
+    return (x > y) - (x < y);
+}
+
+static bool run(const char* mode, Loopback* lb, int burst) {
+    static unsigned char wire[MAX_BURST * 512];
+    Producer p = { lb, wire, 0, false, false };
+    p.wire_len = build_burst(wire, sizeof(wire), burst);
+    agent_text_set(agent_text_mut(&agents[PARTY - 1]), TEXT_NAME, "", 0);
+    int frames = 0;
+    pthread_t producer;
+    pthread_create(&producer, NULL, producer_main, &p);
+
+    u64 settle_start = 0;
+    for (;;) {
+        u64 t = run_frame();
+        if (frames < MAX_FRAMES) frame_ns[frames++] = t;
+        svcSleepThread(FRAME_WAIT_NS);
+
+        if (!__atomic_load_n(&p.done, __ATOMIC_ACQUIRE)) continue;
+        if (settle_start == 0) settle_start = osGetTime();
+        if (strcmp(agent_text(&agents[PARTY - 1])->name, "end") == 0) break;
+        if (osGetTime() - settle_start > SETTLE_MS) {
+            fprintf(stderr, "%s, burst %d: last message never arrived\n", mode, burst);
+            pthread_join(producer, NULL);
+            return false;
+        }
+    }
+    pthread_join(producer, NULL);
+    if (p.failed) return false;
+
+    qsort(frame_ns, frames, sizeof(frame_ns[0]), compare_u64);
+    printf("%-8s burst %5d  frames %6d  median %7.1f us  p99 %7.1f us  worst %7.1f us\n",
+           mode, burst, frames, frame_ns[frames / 2] / 1e3,
+           frame_ns[frames * 99 / 100] / 1e3, frame_ns[frames - 1] / 1e3);
+    return true;
+}
+
+static bool wait_connected(Loopback* lb, bool threaded) {
+    bool accepted = false;
+    for (u64 start = osGetTime(); !network_is_connected(); ) {
+        if (osGetTime() - start > SETTLE_MS) return false;
+        // Inline, the upgrade request is only sent from network_poll
+        if (!accepted && (threaded || network_get_phase() == NET_HANDSHAKE)) {
+            if (!loopback_accept(lb)) return false;
+            accepted = true;
+        }
+        network_poll(agents, &agent_count);
+    }
+    return true;
+}
+
+static const int bursts[] = { 4, 64, 256, MAX_BURST };
+#define BURST_SIZES ((int)(sizeof(bursts) / sizeof(bursts[0])))
+
+int main(void) {
+    Loopback lb;
+    if (!loopback_open(&lb) || !network_init()) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+    ui_init();
+    anim_bank_init(&anims, MAX_AGENTS, &anim_waiting);
+
+    bool ok = network_connect("127.0.0.1", lb.port) && wait_connected(&lb, false);
+    for (int i = 0; ok && i < BURST_SIZES; i++) ok = run("inline", &lb, bursts[i]);
+    network_disconnect();
+    loopback_drop(&lb);
+
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        agent_clear(&agents[i], i);
+    }
+    agent_count = 0;
+    ok = ok && network_start_thread("127.0.0.1", lb.port) && wait_connected(&lb, true);
+    for (int i = 0; ok && i < BURST_SIZES; i++) ok = run("threaded", &lb, bursts[i]);
+    network_stop_thread();
+
+    if (!ok) fprintf(stderr, "stress test failed\n");
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        agent_free(&agents[i]);
+    }
+    ui_exit();
+    network_exit();
+    loopback_close(&lb);
+    return ok ? 0 : 1;
+}
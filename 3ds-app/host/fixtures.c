@@ -0,0 +1,141 @@
+#include "fixtures.h"
+#include <stdio.h>
+#include <string.h>
+
+size_t fixture_status_json(char* out, size_t cap, int slot, int seq, int with_prompt) {
+    int n;
+    if (with_prompt) {
+        n = snprintf(out, cap,
+            "{\"type\":\"agent_status\",\"agent\":\"claude-%d\",\"state\":\"waiting\","
+            "\"progress\":-1,\"message\":\"Bash: npm run build -- --filter=%d\","
+            "\"contextPercent\":%d,\"promptToolType\":\"Bash\","
+            "\"promptToolDetail\":\"npm run build -- --filter=%d && npm test -- --coverage "
+            "--reporter=verbose src/components/dashboard/AgentCard.test.tsx\","
+            "\"promptDescription\":\"Build the project and run the dashboard tests\","
+            "\"autoEdit\":false,\"slot\":%d,\"active\":true,\"seq\":%d}",
+            slot, seq, seq % 101, seq, slot, seq);
+    } else {
+        n = snprintf(out, cap,
+            "{\"type\":\"agent_status\",\"agent\":\"claude-%d\",\"state\":\"working\","
+            "\"progress\":-1,\"message\":\"Tool: Read\",\"contextPercent\":%d,"
+            "\"autoEdit\":false,\"slot\":%d,\"active\":true,\"seq\":%d}",
+            slot, seq % 101, slot, seq);
+    }
+    if (n < 0 || (size_t)n >= cap) return 0;
+    return (size_t)n;
+}
+
+static WireString literal_string(const char* str) {
+    WireString s = { str, (int)strlen(str) };
+    return s;
+}
+
+static WireString scratch_string(char** scratch, size_t* cap, const char* fmt, int arg) {
+    int n = snprintf(*scratch, *cap, fmt, arg);
+    if (n < 0 || (size_t)n >= *cap) n = 0;
+    WireString s = { *scratch, n };
+    *scratch += n;
+    *cap -= n;
+    return s;
+}
+
+void fixture_status_wire(WireMessage* msg, char* scratch, size_t cap,
+                         int slot, int seq, int with_prompt) {
+    memset(msg, 0, sizeof(*msg));
+    msg->type = MSG_AGENT_STATUS;
+    msg->present = FIELD_BIT(FIELD_AGENT) | FIELD_BIT(FIELD_STATE) | FIELD_BIT(FIELD_PROGRESS) |
+                   FIELD_BIT(FIELD_MESSAGE) | FIELD_BIT(FIELD_CONTEXT_PERCENT) |
+                   FIELD_BIT(FIELD_AUTO_EDIT) | FIELD_BIT(FIELD_SLOT) | FIELD_BIT(FIELD_ACTIVE) |
+                   FIELD_BIT(FIELD_SEQ);
+    msg->agent = scratch_string(&scratch, &cap, "claude-%d", slot);
+    msg->progress = -1;
+    msg->context_percent = seq % 101;
+    msg->slot = slot;
+    msg->active = true;
+    msg->seq = seq;
+
+    if (with_prompt) {
+        msg->state = STATE_WAITING;
+        msg->message = scratch_string(&scratch, &cap, "Bash: npm run build -- --filter=%d", seq);
+        msg->prompt_tool_type = literal_string("Bash");
+        msg->prompt_tool_detail = scratch_string(&scratch, &cap,
+            "npm run build -- --filter=%d && npm test -- --coverage "
+            "--reporter=verbose src/components/dashboard/AgentCard.test.tsx", seq);
+        msg->prompt_description = literal_string(
+            "Build the project and run the dashboard tests");
+        msg->present |= FIELD_BIT(FIELD_PROMPT_TOOL_TYPE) | FIELD_BIT(FIELD_PROMPT_TOOL_DETAIL) |
+                        FIELD_BIT(FIELD_PROMPT_DESCRIPTION);
+    } else {
+        msg->state = STATE_WORKING;
+        msg->message = literal_string("Tool: Read");
+    }
+}
+
+size_t fixture_delta_json(char* out, size_t cap, int slot, int seq) {
+    int n = snprintf(out, cap,
+        "{\"type\":\"agent_delta\",\"slot\":%d,\"seq\":%d,"
+        "\"message\":\"Tool: Read\",\"contextPercent\":%d}",
+        slot, seq, seq % 101);
+    if (n < 0 || (size_t)n >= cap) return 0;
+    return (size_t)n;
+}
+
+void fixture_delta_wire(WireMessage* msg, int slot, int seq) {
+    memset(msg, 0, sizeof(*msg));
+    msg->type = MSG_AGENT_DELTA;
+    msg->present = FIELD_BIT(FIELD_SLOT) | FIELD_BIT(FIELD_SEQ) |
+                   FIELD_BIT(FIELD_MESSAGE) | FIELD_BIT(FIELD_CONTEXT_PERCENT);
+    msg->slot = slot;
+    msg->seq = seq;
+    msg->message = literal_string("Tool: Read");
+    msg->context_percent = seq % 101;
+}
+
+size_t fixture_large_status_json(char* out, size_t cap, int slot, int seq, size_t detail_len) {
+    int n = snprintf(out, cap,
+        "{\"type\":\"agent_status\",\"agent\":\"claude-%d\",\"state\":\"waiting\","
+        "\"progress\":-1,\"message\":\"Edit: src/server.ts\",\"contextPercent\":%d,"
+        "\"promptToolType\":\"Edit\",\"promptToolDetail\":\"",
+        slot, seq % 101);
+    if (n < 0 || (size_t)n + detail_len >= cap) return 0;
+
+    static const char words[] = "const next = applyPatch(state, delta); ";
+    for (size_t i = 0; i < detail_len; i++) {
+        out[n++] = words[i % (sizeof(words) - 1)];
+    }
+
+    int tail = snprintf(out + n, cap - n,
+        "\",\"promptDescription\":\"Apply the edit\",\"autoEdit\":false,"
+        "\"slot\":%d,\"active\":true}", slot);
+    if (tail < 0 || (size_t)(n + tail) >= cap) return 0;
+    return (size_t)(n + tail);
+}
+
+size_t fixture_ws_frame(unsigned char* out, size_t cap, int opcode,
+                        const void* payload, size_t len) {
+    return fixture_ws_fragment(out, cap, opcode, 1, payload, len);
+}
+
+size_t fixture_ws_fragment(unsigned char* out, size_t cap, int opcode, int fin,
+                           const void* payload, size_t len) {
+    size_t header = 2;
+    if (len >= 65536) header = 10;
+    else if (len >= 126) header = 4;
+    if (header + len > cap) return 0;
+
+    out[0] = (fin ? 0x80 : 0x00) | (opcode & 0x0F);
+    if (header == 2) {
+        out[1] = (unsigned char)len;
+    } else if (header == 4) {
+        out[1] = 126;
+        out[2] = (len >> 8) & 0xFF;
+        out[3] = len & 0xFF;
+    } else {
+        out[1] = 127;
+        for (int i = 0; i < 8; i++) {
+            out[2 + i] = (unsigned char)(((unsigned long long)len >> (56 - 8 * i)) & 0xFF);
+        }
+    }
+    memcpy(out + header, payload, len);
+    return header + len;
+}
@@ -0,0 +1,37 @@
+#ifndef FIXTURES_H
+#define FIXTURES_H
+
+#include <stddef.h>
+#include "protocol.h"
+
+// Build an agent_status JSON payload shaped like broadcastSlotState() in
+// companion-server/src/server.ts. seq varies progress/context so repeated
+// messages are not byte-identical. with_prompt adds tool prompt fields.
+// Returns the payload length (excluding NUL).
+size_t fixture_status_json(char* out, size_t cap, int slot, int seq, int with_prompt);
+
+// Fill msg with the same content as fixture_status_json. String fields point
+// into scratch (at least 512 bytes), which must outlive msg.
+void fixture_status_wire(WireMessage* msg, char* scratch, size_t cap,
+                         int slot, int seq, int with_prompt);
+
+// agent_delta for one slot carrying a new message and contextPercent, the
+// typical tool-use update. Apply after a full status with seq - 1.
+size_t fixture_delta_json(char* out, size_t cap, int slot, int seq);
+void fixture_delta_wire(WireMessage* msg, int slot, int seq);
+
+// Same shape with a promptToolDetail of detail_len characters, for messages
+// that exceed the client's receive buffer.
+size_t fixture_large_status_json(char* out, size_t cap, int slot, int seq, size_t detail_len);
+
+// Encode a server->client (unmasked) WebSocket frame with FIN set.
+// Picks the 7-bit, 16-bit or 64-bit length form as needed.
+// Returns the frame length, or 0 if it does not fit in cap.
+size_t fixture_ws_frame(unsigned char* out, size_t cap, int opcode,
+                        const void* payload, size_t len);
+
+// Same as fixture_ws_frame, with explicit control of the FIN bit
+size_t fixture_ws_fragment(unsigned char* out, size_t cap, int opcode, int fin,
+                           const void* payload, size_t len);
+
+#endif // FIXTURES_H
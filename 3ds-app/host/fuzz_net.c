@@ -0,0 +1,388 @@
+// Fuzz harness for the receive path. Each input is the byte stream a server
+// sends after the WebSocket upgrade; it is pushed over a fresh loopback
+// connection and drained through network_poll -> process_ws_frames ->
+// parse_message / codec_decode. Build it with sanitizers (make fuzz) so an
+// out-of-bounds read or write in the frame or message decoders aborts.
+//
+// Three ways to drive it:
+//   libFuzzer   make fuzz CC=clang FUZZER=libfuzzer
+//   AFL         make fuzz CC=afl-clang-fast, then afl-fuzz ... -- fuzz_net @@
+//   standalone  fuzz_net [-runs N] [-seed S]   mutates the built-in seeds
+// fuzz_net -corpus DIR writes the seed streams out as a starting corpus.
+//
+// The seeds are shaped like real server traffic (fixtures.c): statuses,
+// deltas, batches, binary frames, fragmented messages with pings in
+// between, and frames right at the edge of the client's receive buffer.
+
+#include "host.h"
+#include "fixtures.h"
+#include "loopback.h"
+#include "network.h"
+#include "agent.h"
+#include "codec.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RECV_BUF_SIZE   4096      // network.c
+#define MAX_INPUT       (96 * 1024)
+#define SEND_CHUNK      8192
+#define MAX_SPINS       100000
+#define MAX_SEEDS       32
+#define DEFAULT_RUNS    20000
+
+static Loopback lb;
+static Agent agents[MAX_AGENTS];
+static int agent_count = 0;
+static bool ready = false;
+
+typedef struct {
+    const char* name;
+    unsigned char* data;
+    size_t len;
+} Seed;
+
+static Seed seeds[MAX_SEEDS];
+static int seed_count = 0;
+
+static void setup(void) {
+    if (ready) return;
+    signal(SIGPIPE, SIG_IGN);
+    if (!loopback_open(&lb) || !network_init()) {
+        fprintf(stderr, "fuzz_net: setup failed\n");
+        abort();
+    }
+    ready = true;
+}
+
+static void poll_once(void) {
+    network_poll(agents, &agent_count);
+}
+
+static void connect_client(void) {
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        agent_clear(&agents[i], i);
+    }
+    agent_count = 0;
+
+    if (!network_connect("127.0.0.1", lb.port)) abort();
+    bool accepted = false;
+    for (int spins = 0; !network_is_connected(); spins++) {
+        if (spins > MAX_SPINS || network_get_phase() == NET_IDLE) {
+            fprintf(stderr, "fuzz_net: handshake failed\n");
+            abort();
+        }
+        if (!accepted && network_get_phase() == NET_HANDSHAKE) {
+            if (!loopback_accept(&lb)) abort();
+            accepted = true;
+        }
+        poll_once();
+    }
+}
+
+// Send the stream in chunks, polling until the client has read each one or
+// dropped the connection. A client that stops reading is a hang.
+static void run_input(const unsigned char* data, size_t len) {
+    connect_client();
+
+    unsigned int base = network_get_stats()->bytes_received;
+    size_t sent = 0;
+    while (sent < len && network_is_connected()) {
+        size_t n = len - sent < SEND_CHUNK ? len - sent : SEND_CHUNK;
+        if (!loopback_send(&lb, data + sent, n)) break;
+        sent += n;
+
+        int spins = 0;
+        while (network_is_connected() && network_get_stats()->bytes_received - base < sent) {
+            poll_once();
+            if (++spins > MAX_SPINS) {
+                fprintf(stderr, "fuzz_net: client stopped reading at %u of %zu bytes\n",
+                        network_get_stats()->bytes_received - base, sent);
+                abort();
+            }
+        }
+    }
+
+    // Pongs, resync requests and the close frame the client sent back
+    char discard[1024];
+    while (loopback_recv(&lb, discard, sizeof(discard)) > 0) {}
+    network_disconnect();
+    loopback_drop(&lb);
+}
+
+int LLVMFuzzerTestOneInput(const unsigned char* data, size_t size) {
+    setup();
+    run_input(data, size);
+    return 0;
+}
+
+// ========== Seeds ==========
+
+static void add_seed(const char* name, const unsigned char* data, size_t len) {
+    if (seed_count == MAX_SEEDS || len == 0) return;
+    unsigned char* copy = malloc(len);
+    if (copy == NULL) abort();
+    memcpy(copy, data, len);
+    seeds[seed_count++] = (Seed){ name, copy, len };
+}
+
+// One text frame per JSON payload
+static size_t text_frames(unsigned char* out, size_t cap, const char* const* json, int count) {
+    size_t len = 0;
+    for (int i = 0; i < count; i++) {
+        len += fixture_ws_frame(out + len, cap - len, 0x1, json[i], strlen(json[i]));
+    }
+    return len;
+}
+
+// A text frame whose whole length (header + payload) is frame_len
+static size_t sized_frame(unsigned char* out, size_t cap, size_t frame_len) {
+    static char json[RECV_BUF_SIZE * 2];
+    size_t header = 4;  // 16-bit length form
+    size_t base = fixture_large_status_json(json, sizeof(json), 3, 1, 0);
+    size_t n = fixture_large_status_json(json, sizeof(json), 3, 1, frame_len - header - base);
+    return fixture_ws_frame(out, cap, 0x1, json, n);
+}
+
+static void build_seeds(void) {
+    static unsigned char wire[MAX_INPUT];
+    static char json[RECV_BUF_SIZE * 4];
+    char a[1024], b[1024], c[1024];
+    size_t len;
+
+    // Full status for every slot, then one of each size
+    len = 0;
+    for (int s = 0; s < DEFAULT_AGENT_SLOTS; s++) {
+        size_t n = fixture_status_json(a, sizeof(a), s, 1, s & 1);
+        len += fixture_ws_frame(wire + len, sizeof(wire) - len, 0x1, a, n);
+    }
+    add_seed("statuses", wire, len);
+
+    // Status followed by in-order deltas and one that skips ahead (resync)
+    fixture_status_json(a, sizeof(a), 2, 5, 0);
+    fixture_delta_json(b, sizeof(b), 2, 6);
+    fixture_delta_json(c, sizeof(c), 2, 9);
+    const char* deltas[] = { a, b, c };
+    add_seed("deltas", wire, text_frames(wire, sizeof(wire), deltas, 3));
+
+    // Batch of four prompts
+    len = (size_t)snprintf(json, sizeof(json), "{\"type\":\"batch\",\"messages\":[");
+    for (int s = 0; s < DEFAULT_AGENT_SLOTS; s++) {
+        if (s > 0) json[len++] = ',';
+        len += fixture_status_json(json + len, sizeof(json) - len, s, 7 + s, 1);
+    }
+    len += (size_t)snprintf(json + len, sizeof(json) - len, "]}");
+    add_seed("batch", wire, fixture_ws_frame(wire, sizeof(wire), 0x1, json, len));
+
+    // Escapes, spawn result, action ack, unknown keys and types, legacy
+    // name lookup
+    const char* misc[] = {
+        "{\"type\":\"agent_status\",\"agent\":\"caf\\u00e9 \\ud83e\\udd80\",\"state\":\"waiting\","
+        "\"promptToolType\":\"Edit\",\"promptToolDetail\":\"a\\\"b\\\\c\\n\\td\",\"slot\":1,\"seq\":3}",
+        "{\"type\":\"spawn_result\",\"success\":true,\"slot\":2}",
+        "{\"type\":\"action_ack\",\"id\":7,\"clientMs\":123456,\"serverMs\":41}",
+        "{\"type\":\"hello\",\"extra\":{\"nested\":[1,2.5,-3,true,null,\"x\"]},\"slot\":0}",
+        "{\"type\":\"agent_status\",\"agent\":\"legacy\",\"state\":\"done\",\"progress\":1e2}",
+    };
+    add_seed("misc", wire, text_frames(wire, sizeof(wire), misc, 5));
+
+    // Binary encoding of a prompt and a delta
+    WireMessage msg;
+    char scratch[512];
+    unsigned char enc[1024];
+    len = 0;
+    fixture_status_wire(&msg, scratch, sizeof(scratch), 1, 4, 1);
+    int n = codec_encode(&msg, enc, sizeof(enc));
+    len += fixture_ws_frame(wire + len, sizeof(wire) - len, 0x2, enc, n > 0 ? (size_t)n : 0);
+    fixture_delta_wire(&msg, 1, 5);
+    n = codec_encode(&msg, enc, sizeof(enc));
+    len += fixture_ws_frame(wire + len, sizeof(wire) - len, 0x2, enc, n > 0 ? (size_t)n : 0);
+    add_seed("binary", wire, len);
+
+    // 12 KB message in four fragments with pings in between
+    static const char ping[] = "hb";
+    size_t large = fixture_large_status_json(json, sizeof(json), 3, 2, 12 * 1024);
+    size_t chunk = (large + 3) / 4;
+    len = 0;
+    for (int f = 0; f < 4; f++) {
+        size_t off = f * chunk;
+        size_t part = off + chunk < large ? chunk : large - off;
+        len += fixture_ws_fragment(wire + len, sizeof(wire) - len, f == 0 ? 0x1 : 0x0,
+                                   f == 3, json + off, part);
+        if (f < 3) len += fixture_ws_frame(wire + len, sizeof(wire) - len, 0x9, ping, 2);
+    }
+    add_seed("fragmented", wire, len);
+
+    // Frames one byte either side of filling the receive buffer: in place
+    // below it, reassembled above
+    len = 0;
+    len += sized_frame(wire + len, sizeof(wire) - len, RECV_BUF_SIZE - 1);
+    len += sized_frame(wire + len, sizeof(wire) - len, RECV_BUF_SIZE);
+    len += sized_frame(wire + len, sizeof(wire) - len, RECV_BUF_SIZE + 1);
+    add_seed("recv_buf edge", wire, len);
+
+    // 64-bit length beyond the message limit, then a close
+    static const unsigned char oversized[] = {
+        0x81, 127, 0, 0, 0, 0, 0x7F, 0xFF, 0xFF, 0xFF, '{',
+    };
+    add_seed("oversized", oversized, sizeof(oversized));
+    static const unsigned char closing[] = { 0x88, 2, 0x03, 0xE8 };
+    add_seed("close", closing, sizeof(closing));
+}
+
+static bool write_corpus(const char* dir) {
+    for (int i = 0; i < seed_count; i++) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/seed-%02d", dir, i);
+        FILE* f = fopen(path, "wb");
+        if (f == NULL) {
+            perror(path);
+            return false;
+        }
+        fwrite(seeds[i].data, 1, seeds[i].len, f);
+        fclose(f);
+    }
+    printf("wrote %d seeds to %s\n", seed_count, dir);
+    return true;
+}
+
+// ========== Standalone mutation ==========
+
+static unsigned long long rng_state = 1;
+
+static unsigned int rng(void) {
+    // xorshift64*
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (unsigned int)((rng_state * 2685821657736338717ULL) >> 32);
+}
+
+static size_t mutate(unsigned char* buf, size_t len, size_t cap) {
+    static const unsigned char interesting[] = {
+        0x00, 0x01, 0x7D, 0x7E, 0x7F, 0x80, 0x81, 0x82, 0x88, 0x89, 0xFF,
+        '{', '}', '[', ']', '"', '\\', ',', ':', '-', '0', 'e',
+    };
+    int count = 1 + rng() % 8;
+    for (int m = 0; m < count && len > 0; m++) {
+        size_t at = rng() % len;
+        switch (rng() % 6) {
+            case 0:  // flip a bit
+                buf[at] ^= (unsigned char)(1u << (rng() % 8));
+                break;
+            case 1:  // interesting byte, often a header length
+                buf[at] = interesting[rng() % sizeof(interesting)];
+                break;
+            case 2:  // insert a byte
+                if (len < cap) {
+                    memmove(buf + at + 1, buf + at, len - at);
+                    buf[at] = (unsigned char)rng();
+                    len++;
+                }
+                break;
+            case 3: {  // delete a run
+                size_t n = 1 + rng() % 16;
+                if (n > len - at) n = len - at;
+                memmove(buf + at, buf + at + n, len - at - n);
+                len -= n;
+                break;
+            }
+            case 4: {  // duplicate a run
+                size_t n = 1 + rng() % 64;
+                if (n > len - at) n = len - at;
+                if (len + n <= cap) {
+                    memmove(buf + at + n, buf + at, len - at);
+                    len += n;
+                }
+                break;
+            }
+            default: {  // splice in part of another seed
+                const Seed* other = &seeds[rng() % seed_count];
+                size_t from = rng() % other->len;
+                size_t n = 1 + rng() % 256;
+                if (n > other->len - from) n = other->len - from;
+                if (n > cap - at) n = cap - at;
+                memcpy(buf + at, other->data + from, n);
+                if (at + n > len) len = at + n;
+                break;
+            }
+        }
+    }
+    return len;
+}
+
+static int run_standalone(int runs) {
+    static unsigned char buf[MAX_INPUT];
+    NetworkStats before = *network_get_stats();
+    u64 allocs = host_stats.heap_allocs;
+    size_t bytes = 0;
+    host_stack_paint();
+    u64 start = host_now_ns();
+
+    for (int i = 0; i < seed_count; i++) {
+        run_input(seeds[i].data, seeds[i].len);
+        bytes += seeds[i].len;
+    }
+    for (int i = 0; i < runs; i++) {
+        const Seed* seed = &seeds[rng() % seed_count];
+        memcpy(buf, seed->data, seed->len);
+        size_t len = mutate(buf, seed->len, sizeof(buf));
+        run_input(buf, len);
+        bytes += len;
+    }
+
+    u64 elapsed = host_now_ns() - start;
+    size_t stack = host_stack_used();
+    const NetworkStats* after = network_get_stats();
+    unsigned int messages = after->messages - before.messages;
+    int inputs = seed_count + runs;
+    printf("%d inputs  %8.0f inputs/s  %9.0f msg/s  %6.1f MB/s  %5.2f allocs/msg  %zu B stack  %u json fallbacks\n",
+           inputs, inputs * 1e9 / elapsed, messages * 1e9 / elapsed, bytes * 1e3 / elapsed,
+           messages ? (double)(host_stats.heap_allocs - allocs) / messages : 0.0, stack,
+           after->json_fallbacks - before.json_fallbacks);
+    return 0;
+}
+
+static int run_file(const char* path) {
+    static unsigned char buf[MAX_INPUT];
+    FILE* f = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    size_t len = fread(buf, 1, sizeof(buf), f);
+    if (f != stdin) fclose(f);
+    run_input(buf, len);
+    return 0;
+}
+
+#ifndef HOST_LIBFUZZER
+int main(int argc, char** argv) {
+    setup();
+    build_seeds();
+
+    int runs = DEFAULT_RUNS;
+    int files = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-runs") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc) {
+            rng_state = strtoull(argv[++i], NULL, 0) | 1;
+        } else if (strcmp(argv[i], "-corpus") == 0 && i + 1 < argc) {
+            return write_corpus(argv[++i]) ? 0 : 1;
+        } else {
+            if (run_file(argv[i]) != 0) return 1;
+            files++;
+        }
+    }
+    int result = files > 0 ? 0 : run_standalone(runs);
+
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        agent_free(&agents[i]);
+    }
+    network_exit();
+    loopback_close(&lb);
+    return result;
+}
+#endif
@@ -0,0 +1,36 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <3ds.h>
+#include <stddef.h>
+
+// Counters updated by the host platform layer (platform.c).
+// Benchmarks reset them with host_stats_reset() and read them after a run.
+typedef struct {
+    u64 rect_draws;       // C2D_DrawRectSolid calls
+    u64 image_draws;      // C2D_DrawImageAt calls
+    u64 text_parses;      // C2D_TextParse calls
+    u64 text_draws;       // C2D_DrawText calls
+    u64 glyphs_parsed;    // glyphs written into text buffers
+    u64 textbuf_overflows; // parses that ran out of glyph space
+    u64 heap_allocs;      // malloc/calloc/realloc calls from client code
+} HostStats;
+
+extern HostStats host_stats;
+
+void host_stats_reset(void);
+
+// What ACU_GetWifiStatus reports: 0 with no WiFi connection, 1 otherwise.
+// Benchmarks clear it to simulate a dropped link.
+extern volatile u32 host_wifi_status;
+
+// Monotonic wall clock in nanoseconds, for benchmark timing
+u64 host_now_ns(void);
+
+// Stack high-water mark. host_stack_paint fills the stack below the
+// caller with a pattern; host_stack_used then reports the most of it that
+// calls made from that same frame have used since. Main thread only.
+void host_stack_paint(void);
+size_t host_stack_used(void);
+
+#endif // HOST_H
@@ -0,0 +1,58 @@
+#ifndef HOST_3DS_H
+#define HOST_3DS_H
+
+// Host (Linux) stand-in for libctru's <3ds.h>.
+// Only the types and services used by the shared sources are provided;
+// everything is implemented in host/platform.c.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t   s8;
+typedef int16_t  s16;
+typedef int32_t  s32;
+typedef int64_t  s64;
+typedef s32      Result;
+typedef u32      Handle;
+
+#define BIT(n) (1U << (n))
+#define R_SUCCEEDED(res) ((res) >= 0)
+#define R_FAILED(res)    ((res) < 0)
+#define U64_MAX UINT64_MAX
+
+typedef struct {
+    u16 px;
+    u16 py;
+} touchPosition;
+
+// SOC service — sockets are plain BSD sockets on the host
+Result socInit(u32* context_addr, u32 context_size);
+Result socExit(void);
+
+// AC service. ACU_GetWifiStatus reports host_wifi_status (host.h), 1
+// unless a benchmark takes the link down.
+Result acInit(void);
+void acExit(void);
+Result ACU_GetWifiStatus(u32* out);
+
+// Threads (pthreads on the host). Priority and core are ignored.
+#define CUR_THREAD_HANDLE 0xFFFF8000
+typedef void (*ThreadFunc)(void*);
+typedef struct Thread_tag* Thread;
+
+Thread threadCreate(ThreadFunc entrypoint, void* arg, size_t stack_size,
+                    int prio, int core_id, bool detached);
+Result threadJoin(Thread thread, u64 timeout_ns);
+void threadFree(Thread thread);
+Result svcGetThreadPriority(s32* out, Handle handle);
+void svcSleepThread(s64 ns);
+
+// Milliseconds since an arbitrary epoch (CLOCK_MONOTONIC on the host)
+u64 osGetTime(void);
+
+#endif // HOST_3DS_H
@@ -0,0 +1,96 @@
+#ifndef HOST_CITRO2D_H
+#define HOST_CITRO2D_H
+
+// Host (Linux) stand-in for <citro2d.h>.
+// Draw calls do not render anything; they are counted in host_stats
+// (see host.h) so benchmarks can measure per-frame draw and text work.
+
+#include <3ds.h>
+
+typedef struct C3D_RenderTarget_tag C3D_RenderTarget;
+typedef struct C2D_TextBuf_s* C2D_TextBuf;
+typedef struct C2D_Font_s* C2D_Font;
+
+typedef struct {
+    C2D_TextBuf buf;
+    size_t begin;
+    size_t end;
+    float width;
+    u32 lines;
+    u32 words;
+    C2D_Font font;
+} C2D_Text;
+
+enum {
+    C2D_AtBaseline = BIT(0),
+    C2D_WithColor  = BIT(1),
+    C2D_AlignLeft  = 0,
+};
+
+static inline u32 C2D_Color32(u8 r, u8 g, u8 b, u8 a) {
+    return r | (g << 8) | (b << 16) | ((u32)a << 24);
+}
+
+// citro3d textures. C3D_TexInit allocates plain memory for the texels.
+typedef enum { GPU_RGBA8 = 0 } GPU_TEXCOLOR;
+typedef enum { GPU_NEAREST = 0, GPU_LINEAR = 1 } GPU_TEXTURE_FILTER_PARAM;
+
+typedef struct {
+    void* data;
+    GPU_TEXCOLOR fmt;
+    u16 width;
+    u16 height;
+} C3D_Tex;
+
+bool C3D_TexInit(C3D_Tex* tex, u16 width, u16 height, GPU_TEXCOLOR format);
+void C3D_TexSetFilter(C3D_Tex* tex, GPU_TEXTURE_FILTER_PARAM magFilter,
+                      GPU_TEXTURE_FILTER_PARAM minFilter);
+void C3D_TexFlush(C3D_Tex* tex);
+void C3D_TexDelete(C3D_Tex* tex);
+
+typedef struct {
+    u16 width;
+    u16 height;
+    float left;
+    float top;
+    float right;
+    float bottom;
+} Tex3DS_SubTexture;
+
+typedef struct {
+    C3D_Tex* tex;
+    const Tex3DS_SubTexture* subtex;
+} C2D_Image;
+
+typedef struct {
+    u32 color;
+    float blend;
+} C2D_Tint;
+
+typedef struct {
+    C2D_Tint corners[4];
+} C2D_ImageTint;
+
+static inline void C2D_PlainImageTint(C2D_ImageTint* tint, u32 color, float blend) {
+    for (int i = 0; i < 4; i++) {
+        tint->corners[i].color = color;
+        tint->corners[i].blend = blend;
+    }
+}
+
+void C2D_TargetClear(C3D_RenderTarget* target, u32 color);
+void C2D_SceneBegin(C3D_RenderTarget* target);
+
+bool C2D_DrawRectSolid(float x, float y, float z, float w, float h, u32 clr);
+bool C2D_DrawImageAt(C2D_Image img, float x, float y, float depth,
+                     const C2D_ImageTint* tint, float scaleX, float scaleY);
+
+C2D_TextBuf C2D_TextBufNew(size_t maxGlyphs);
+void C2D_TextBufDelete(C2D_TextBuf buf);
+void C2D_TextBufClear(C2D_TextBuf buf);
+const char* C2D_TextParse(C2D_Text* text, C2D_TextBuf buf, const char* str);
+void C2D_TextOptimize(const C2D_Text* text);
+void C2D_DrawText(const C2D_Text* text, u32 flags, float x, float y, float z,
+                  float scaleX, float scaleY, ...);
+
+#endif // HOST_CITRO2D_H
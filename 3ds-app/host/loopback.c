@@ -0,0 +1,99 @@
+#include "loopback.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+bool loopback_open(Loopback* lb) {
+    memset(lb, 0, sizeof(*lb));
+    lb->conn_fd = -1;
+    lb->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (lb->listen_fd < 0) return false;
+
+    int one = 1;
+    setsockopt(lb->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(lb->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(lb->listen_fd, 1) < 0) {
+        close(lb->listen_fd);
+        lb->listen_fd = -1;
+        return false;
+    }
+
+    socklen_t addr_len = sizeof(addr);
+    getsockname(lb->listen_fd, (struct sockaddr*)&addr, &addr_len);
+    lb->port = ntohs(addr.sin_port);
+    return true;
+}
+
+bool loopback_accept(Loopback* lb) {
+    lb->conn_fd = accept(lb->listen_fd, NULL, NULL);
+    if (lb->conn_fd < 0) return false;
+
+    // Push each burst immediately rather than letting Nagle batch them
+    int one = 1;
+    setsockopt(lb->conn_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    // Read the upgrade request up to the blank line
+    char* req = lb->request;
+    int req_len = 0;
+    while (req_len < (int)sizeof(lb->request) - 1) {
+        int n = recv(lb->conn_fd, req + req_len, sizeof(lb->request) - 1 - req_len, 0);
+        if (n <= 0) return false;
+        req_len += n;
+        req[req_len] = '\0';
+        if (strstr(req, "\r\n\r\n")) break;
+    }
+
+    char epoch[32] = "";
+    if (lb->epoch != 0) snprintf(epoch, sizeof(epoch), "X-Raids-Epoch: %d\r\n", lb->epoch);
+    char response[256];
+    int len = snprintf(response, sizeof(response),
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n"
+        "%s"
+        "\r\n", epoch);
+    return loopback_send(lb, response, (size_t)len);
+}
+
+bool loopback_send(Loopback* lb, const void* data, size_t len) {
+    const char* p = data;
+    while (len > 0) {
+        ssize_t n = send(lb->conn_fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+int loopback_recv(Loopback* lb, void* buf, size_t cap) {
+    ssize_t n = recv(lb->conn_fd, buf, cap, MSG_DONTWAIT);
+    return n > 0 ? (int)n : 0;
+}
+
+void loopback_drop(Loopback* lb) {
+    if (lb->conn_fd >= 0) close(lb->conn_fd);
+    lb->conn_fd = -1;
+}
+
+void loopback_close(Loopback* lb) {
+    if (lb->conn_fd >= 0) close(lb->conn_fd);
+    if (lb->listen_fd >= 0) close(lb->listen_fd);
+    lb->conn_fd = -1;
+    lb->listen_fd = -1;
+}
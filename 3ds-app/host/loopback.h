@@ -0,0 +1,35 @@
+#ifndef LOOPBACK_H
+#define LOOPBACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Minimal in-process stand-in for the companion server: a TCP listener on
+// 127.0.0.1 that completes the WebSocket handshake and lets benchmarks push
+// raw frames at the client in network.c.
+typedef struct {
+    int listen_fd;
+    int conn_fd;
+    int port;
+    int epoch;            // sent as X-Raids-Epoch when nonzero
+    char request[1024];   // the last upgrade request
+} Loopback;
+
+// Listen on an ephemeral loopback port (lb->port is filled in)
+bool loopback_open(Loopback* lb);
+
+// Accept the client, read its upgrade request and answer 101
+bool loopback_accept(Loopback* lb);
+
+// Blocking write of the whole buffer to the client
+bool loopback_send(Loopback* lb, const void* data, size_t len);
+
+// Read whatever the client has sent (non-blocking); returns bytes read
+int loopback_recv(Loopback* lb, void* buf, size_t cap);
+
+// Close the client connection but keep listening for the next one
+void loopback_drop(Loopback* lb);
+
+void loopback_close(Loopback* lb);
+
+#endif // LOOPBACK_H
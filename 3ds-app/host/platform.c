@@ -0,0 +1,240 @@
+#include "host.h"
+#include <citro2d.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+HostStats host_stats;
+
+void host_stats_reset(void) {
+    memset(&host_stats, 0, sizeof(host_stats));
+}
+
+u64 host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000ULL + (u64)ts.tv_nsec;
+}
+
+// ========== Heap and stack ==========
+
+// The Makefile links with --wrap for these, so every allocation made by
+// client code lands here first
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    __atomic_fetch_add(&host_stats.heap_allocs, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    __atomic_fetch_add(&host_stats.heap_allocs, 1, __ATOMIC_RELAXED);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    __atomic_fetch_add(&host_stats.heap_allocs, 1, __ATOMIC_RELAXED);
+    return __real_realloc(ptr, size);
+}
+
+#define STACK_PAINT_SIZE (256 * 1024)
+#define STACK_PAINT_BYTE 0xA5
+
+// Bounds of the painted region, kept as integers: the region belongs to a
+// frame that has returned by the time it is scanned
+static uintptr_t paint_low;
+static uintptr_t paint_high;
+
+__attribute__((noinline, no_sanitize_address))
+void host_stack_paint(void) {
+    volatile unsigned char region[STACK_PAINT_SIZE];
+    for (size_t i = 0; i < sizeof(region); i++) {
+        region[i] = STACK_PAINT_BYTE;
+    }
+    paint_low = (uintptr_t)region;
+    paint_high = paint_low + sizeof(region);
+}
+
+__attribute__((noinline, no_sanitize_address))
+size_t host_stack_used(void) {
+    if (paint_low == 0) return 0;
+    uintptr_t p = paint_low;
+    while (p < paint_high && *(volatile unsigned char*)p == STACK_PAINT_BYTE) p++;
+    return (size_t)(paint_high - p);
+}
+
+// ========== libctru ==========
+
+Result socInit(u32* context_addr, u32 context_size) {
+    (void)context_addr;
+    (void)context_size;
+    return 0;
+}
+
+Result socExit(void) {
+    return 0;
+}
+
+volatile u32 host_wifi_status = 1;
+
+Result acInit(void) {
+    return 0;
+}
+
+void acExit(void) {
+}
+
+Result ACU_GetWifiStatus(u32* out) {
+    *out = host_wifi_status;
+    return 0;
+}
+
+struct Thread_tag {
+    pthread_t handle;
+    ThreadFunc entry;
+    void* arg;
+};
+
+static void* thread_trampoline(void* p) {
+    Thread t = p;
+    t->entry(t->arg);
+    return NULL;
+}
+
+Thread threadCreate(ThreadFunc entrypoint, void* arg, size_t stack_size,
+                    int prio, int core_id, bool detached) {
+    (void)stack_size; (void)prio; (void)core_id;
+    Thread t = calloc(1, sizeof(*t));
+    if (t == NULL) return NULL;
+    t->entry = entrypoint;
+    t->arg = arg;
+    if (pthread_create(&t->handle, NULL, thread_trampoline, t) != 0) {
+        free(t);
+        return NULL;
+    }
+    if (detached) pthread_detach(t->handle);
+    return t;
+}
+
+Result threadJoin(Thread thread, u64 timeout_ns) {
+    (void)timeout_ns;  // always waits
+    return pthread_join(thread->handle, NULL) == 0 ? 0 : -1;
+}
+
+void threadFree(Thread thread) {
+    free(thread);
+}
+
+Result svcGetThreadPriority(s32* out, Handle handle) {
+    (void)handle;
+    *out = 0x30;
+    return 0;
+}
+
+void svcSleepThread(s64 ns) {
+    struct timespec ts = { ns / 1000000000LL, ns % 1000000000LL };
+    nanosleep(&ts, NULL);
+}
+
+u64 osGetTime(void) {
+    return host_now_ns() / 1000000ULL;
+}
+
+// ========== citro2d ==========
+
+struct C2D_TextBuf_s {
+    size_t max_glyphs;
+    size_t num_glyphs;
+};
+
+void C2D_TargetClear(C3D_RenderTarget* target, u32 color) {
+    (void)target;
+    (void)color;
+}
+
+void C2D_SceneBegin(C3D_RenderTarget* target) {
+    (void)target;
+}
+
+bool C2D_DrawRectSolid(float x, float y, float z, float w, float h, u32 clr) {
+    (void)x; (void)y; (void)z; (void)w; (void)h; (void)clr;
+    host_stats.rect_draws++;
+    return true;
+}
+
+bool C2D_DrawImageAt(C2D_Image img, float x, float y, float depth,
+                     const C2D_ImageTint* tint, float scaleX, float scaleY) {
+    (void)img; (void)x; (void)y; (void)depth; (void)tint; (void)scaleX; (void)scaleY;
+    host_stats.image_draws++;
+    return true;
+}
+
+bool C3D_TexInit(C3D_Tex* tex, u16 width, u16 height, GPU_TEXCOLOR format) {
+    tex->data = calloc((size_t)width * height, sizeof(u32));
+    tex->fmt = format;
+    tex->width = width;
+    tex->height = height;
+    return tex->data != NULL;
+}
+
+void C3D_TexSetFilter(C3D_Tex* tex, GPU_TEXTURE_FILTER_PARAM magFilter,
+                      GPU_TEXTURE_FILTER_PARAM minFilter) {
+    (void)tex; (void)magFilter; (void)minFilter;
+}
+
+void C3D_TexFlush(C3D_Tex* tex) {
+    (void)tex;
+}
+
+void C3D_TexDelete(C3D_Tex* tex) {
+    free(tex->data);
+    tex->data = NULL;
+}
+
+C2D_TextBuf C2D_TextBufNew(size_t maxGlyphs) {
+    C2D_TextBuf buf = calloc(1, sizeof(*buf));
+    if (buf) buf->max_glyphs = maxGlyphs;
+    return buf;
+}
+
+void C2D_TextBufDelete(C2D_TextBuf buf) {
+    free(buf);
+}
+
+void C2D_TextBufClear(C2D_TextBuf buf) {
+    if (buf) buf->num_glyphs = 0;
+}
+
+const char* C2D_TextParse(C2D_Text* text, C2D_TextBuf buf, const char* str) {
+    host_stats.text_parses++;
+    size_t len = strlen(str);
+    size_t space = buf->max_glyphs - buf->num_glyphs;
+    if (len > space) {
+        host_stats.textbuf_overflows++;
+        len = space;
+    }
+    text->buf = buf;
+    text->begin = buf->num_glyphs;
+    text->end = buf->num_glyphs + len;
+    text->width = (float)len;
+    text->lines = 1;
+    text->words = 1;
+    text->font = NULL;
+    buf->num_glyphs += len;
+    host_stats.glyphs_parsed += len;
+    return str + len;
+}
+
+void C2D_TextOptimize(const C2D_Text* text) {
+    (void)text;
+}
+
+void C2D_DrawText(const C2D_Text* text, u32 flags, float x, float y, float z,
+                  float scaleX, float scaleY, ...) {
+    (void)text; (void)flags; (void)x; (void)y; (void)z; (void)scaleX; (void)scaleY;
+    host_stats.text_draws++;
+}
@@ -0,0 +1,74 @@
+#include "agent.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const AgentText empty_text;
+
+// Where each AgentTextField lives in AgentText
+#define FIELD(member) { offsetof(AgentText, member), sizeof(((AgentText*)0)->member) }
+static const struct {
+    uint16_t offset;
+    uint16_t size;
+} text_fields[TEXT_FIELD_COUNT] = {
+    [TEXT_NAME]            = FIELD(name),
+    [TEXT_MESSAGE]         = FIELD(message),
+    [TEXT_PENDING_COMMAND] = FIELD(pending_command),
+    [TEXT_TOOL_TYPE]       = FIELD(prompt_tool_type),
+    [TEXT_TOOL_DETAIL]     = FIELD(prompt_tool_detail),
+    [TEXT_DESCRIPTION]     = FIELD(prompt_description),
+};
+
+const AgentText* agent_text(const Agent* agent) {
+    return agent->text ? agent->text : &empty_text;
+}
+
+AgentText* agent_text_mut(Agent* agent) {
+    if (agent->text == NULL) {
+        agent->text = calloc(1, sizeof(AgentText));
+    }
+    return agent->text;
+}
+
+bool agent_text_set(AgentText* text, AgentTextField field, const char* str, int len) {
+    char* dst = (char*)text + text_fields[field].offset;
+    int n = (len < text_fields[field].size - 1) ? len : text_fields[field].size - 1;
+
+    // Most updates repeat what the slot already shows
+    if (n == text->len[field] && memcmp(dst, str, n) == 0) return false;
+
+    memcpy(dst, str, n);
+    dst[n] = '\0';
+    text->len[field] = (uint16_t)n;
+    text->hash[field] = agent_hash_text(dst, n);
+    return true;
+}
+
+const char* agent_text_field(const AgentText* text, AgentTextField field) {
+    return (const char*)text + text_fields[field].offset;
+}
+
+void agent_clear(Agent* agent, int slot) {
+    AgentText* text = agent->text;
+    memset(agent, 0, sizeof(*agent));
+    if (text) memset(text, 0, sizeof(*text));
+    agent->text = text;
+    agent->state = STATE_IDLE;
+    agent->progress = -1;
+    agent->slot = (uint8_t)slot;
+}
+
+void agent_copy(Agent* dst, const Agent* src) {
+    AgentText* text = dst->text;
+    *dst = *src;
+    dst->text = text;
+    if (src->text && agent_text_mut(dst)) {
+        memcpy(dst->text, src->text, sizeof(AgentText));
+    } else if (text) {
+        memset(text, 0, sizeof(*text));
+    }
+}
+
+void agent_free(Agent* agent) {
+    free(agent->text);
+    agent->text = NULL;
+}
@@ -0,0 +1,41 @@
+#ifndef AGENT_H
+#define AGENT_H
+
+#include <stddef.h>
+#include "protocol.h"
+
+// FNV-1a of len bytes of str. Keys AgentText fields and ui.c's text cache.
+static inline uint32_t agent_hash_text(const char* str, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) h = (h ^ (uint8_t)str[i]) * 16777619u;
+    return h;
+}
+
+// Text of an agent for reading. Never NULL: a slot without text reads as
+// empty strings.
+const AgentText* agent_text(const Agent* agent);
+
+// Text of an agent for writing, allocated on first use.
+// Returns NULL if out of memory.
+AgentText* agent_text_mut(Agent* agent);
+
+// Set one text field to len bytes of str, truncated to fit. Compares
+// against the current value first and leaves it untouched if equal.
+// Returns true if the field changed.
+bool agent_text_set(AgentText* text, AgentTextField field, const char* str, int len);
+
+// Contents of one text field
+const char* agent_text_field(const AgentText* text, AgentTextField field);
+
+// Make agent an empty idle agent in slot. An allocated text is kept and
+// cleared, since the slot is likely to be filled again.
+void agent_clear(Agent* agent, int slot);
+
+// Copy src into dst. dst keeps its own text allocation (created if src has
+// text), so the two can live on different threads.
+void agent_copy(Agent* dst, const Agent* src);
+
+// Release the text of agent
+void agent_free(Agent* agent);
+
+#endif // AGENT_H
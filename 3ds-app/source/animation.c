@@ -2,89 +2,155 @@
 #include "creature.h"
 #include <string.h>
 
-// We store the creature frames used by each animation inline.
-// idle: 2 frames (normal + raised), 20 ticks/frame = ~3Hz
-// working: 2 frames (normal + raised), 10 ticks/frame = ~6Hz
-// waiting: 2 frames (normal + raised), 8 ticks/frame = ~7.5Hz
+// A step longer than this (sleep mode, HOME menu) resumes the animation
+// where it was instead of fast-forwarding through it
+#define ANIM_MAX_STEP_MS 1000
 
-// For idle/working/waiting, we reference the same clawd pixel data
-// but with different tick rates. The caller can apply color tint
-// based on the animation type if desired.
+#define CLR_WAIT_FLASH  0xFFAFE2F9  // Yellow #f9e2af
+#define CLR_MATERIALIZE 0xFFFFFFFF
 
-// We use creature_get_clawd_frame() to get the actual frame data,
-// so AnimDef.frames just needs to hold the frame count metadata.
-// We'll store dummy frames and use anim_current_frame() to dispatch.
+// Plain keyframe: sprite shown as-is for ms
+#define KEY(sprite, ms) { (sprite), 0, 0, 1.0f, 0, 0.0f, (ms) }
 
 // Idle animation: gentle bob at ~3Hz
-static const CreatureFrame idle_frames_placeholder[2] = {0};
+static const AnimKeyframe idle_keys[] = {
+    KEY(SPRITE_CLAWD, 333),
+    KEY(SPRITE_CLAWD_RAISED, 333),
+};
 const AnimDef anim_idle = {
-    .frames = idle_frames_placeholder,
-    .frame_count = 2,
-    .ticks_per_frame = 20,  // 60fps / 20 = 3Hz
+    .keys = idle_keys,
+    .key_count = 2,
     .one_shot = false,
 };
 
 // Working animation: faster pulse at ~6Hz
-static const CreatureFrame working_frames_placeholder[2] = {0};
+static const AnimKeyframe working_keys[] = {
+    KEY(SPRITE_CLAWD, 167),
+    KEY(SPRITE_CLAWD_RAISED, 167),
+};
 const AnimDef anim_working = {
-    .frames = working_frames_placeholder,
-    .frame_count = 2,
-    .ticks_per_frame = 10,  // 60fps / 10 = 6Hz
+    .keys = working_keys,
+    .key_count = 2,
     .one_shot = false,
 };
 
-// Waiting animation: urgent flash at ~7.5Hz
-static const CreatureFrame waiting_frames_placeholder[2] = {0};
+// Waiting animation: urgent flash at ~7.5Hz, yellow on the up beat
+static const AnimKeyframe waiting_keys[] = {
+    KEY(SPRITE_CLAWD, 133),
+    { SPRITE_CLAWD_RAISED, 0, 0, 1.0f, CLR_WAIT_FLASH, 0.35f, 133 },
+};
 const AnimDef anim_waiting = {
-    .frames = waiting_frames_placeholder,
-    .frame_count = 2,
-    .ticks_per_frame = 8,   // 60fps / 8 = 7.5Hz
+    .keys = waiting_keys,
+    .key_count = 2,
     .one_shot = false,
 };
 
-// Spawn animation: pokeball one-shot ~1.5s (90 frames at 60fps)
-// Uses 6 keyframes: ball grow, split, flash, materialize, settle, idle
-static const CreatureFrame spawn_frames_placeholder[6] = {0};
+// Spawn animation: pokeball one-shot, 1.5s
+// ball grows, splits, flashes, Clawd materializes and settles
+static const AnimKeyframe spawn_keys[] = {
+    { SPRITE_BALL,         0, 0, 0.5f, 0, 0.0f, 200 },
+    { SPRITE_BALL,         0, 0, 1.0f, 0, 0.0f, 200 },
+    { SPRITE_BALL_OPEN,    0, 0, 1.0f, 0, 0.0f, 250 },
+    { SPRITE_FLASH,        0, 0, 1.0f, 0, 0.0f, 250 },
+    { SPRITE_CLAWD,        0, 0, 1.0f, CLR_MATERIALIZE, 0.6f, 250 },
+    { SPRITE_CLAWD_RAISED, 0, 0, 1.0f, 0, 0.0f, 200 },
+    KEY(SPRITE_CLAWD, 150),
+};
 const AnimDef anim_spawn = {
-    .frames = spawn_frames_placeholder,
-    .frame_count = 6,
-    .ticks_per_frame = 15,  // 90 frames / 6 keyframes = 15 ticks each
+    .keys = spawn_keys,
+    .key_count = 7,
     .one_shot = true,
 };
 
-void anim_tick(AnimState* state) {
-    if (!state || !state->current) return;
-    if (state->finished) return;
-
-    state->tick_counter++;
-    if (state->tick_counter >= state->current->ticks_per_frame) {
-        state->tick_counter = 0;
-        state->frame_index++;
-
-        if (state->frame_index >= state->current->frame_count) {
-            if (state->current->one_shot) {
-                state->frame_index = state->current->frame_count - 1;
-                state->finished = true;
-            } else {
-                state->frame_index = 0;
-            }
-        }
+static void start_anim(AnimBank* bank, int slot, const AnimDef* def) {
+    bank->current[slot] = def;
+    bank->frame_index[slot] = 0;
+    bank->elapsed_ms[slot] = 0;
+    bank->duration_ms[slot] = (def && def->key_count > 0) ? def->keys[0].duration_ms : 0;
+}
+
+void anim_bank_init(AnimBank* bank, int count, const AnimDef* def) {
+    memset(bank, 0, sizeof(*bank));
+    bank->count = count < ANIM_MAX_SLOTS ? count : ANIM_MAX_SLOTS;
+    for (int i = 0; i < bank->count; i++) {
+        start_anim(bank, i, def);
+        bank->next[i] = def;
     }
 }
 
-void anim_set(AnimState* state, const AnimDef* def) {
-    if (!state) return;
-    state->current = def;
-    state->frame_index = 0;
-    state->tick_counter = 0;
-    state->finished = false;
+bool anim_bank_set(AnimBank* bank, int slot, const AnimDef* def) {
+    if (slot < 0 || slot >= bank->count) return false;
+    bank->next[slot] = def;
+    const AnimDef* current = bank->current[slot];
+    bool one_shot_playing = current && current->one_shot && bank->duration_ms[slot] != 0;
+    if (current == def || one_shot_playing) return false;
+    start_anim(bank, slot, def);
+    return true;
+}
+
+void anim_bank_play(AnimBank* bank, int slot, const AnimDef* once) {
+    if (slot < 0 || slot >= bank->count) return;
+    start_anim(bank, slot, once);
+}
+
+// Move a slot past every keyframe it has outlived; the slow path of
+// anim_bank_tick. Several keyframes may pass when frames were skipped.
+// Returns true if the displayed keyframe changed.
+static bool advance_slot(AnimBank* bank, int slot) {
+    const AnimDef* def = bank->current[slot];
+    int index = bank->frame_index[slot];
+    u32 elapsed = bank->elapsed_ms[slot];
+    u16 duration = bank->duration_ms[slot];
+
+    while (duration != 0 && elapsed >= duration) {
+        elapsed -= duration;
+        if (index + 1 < def->key_count) {
+            index++;
+        } else if (!def->one_shot) {
+            index = 0;
+        } else if (bank->next[slot] && bank->next[slot] != def) {
+            // One-shot done, back to the slot's loop
+            start_anim(bank, slot, bank->next[slot]);
+            return true;
+        } else {
+            duration = 0;  // hold the last keyframe
+            break;
+        }
+        duration = def->keys[index].duration_ms;
+    }
+
+    bool changed = index != bank->frame_index[slot];
+    bank->frame_index[slot] = (u8)index;
+    bank->elapsed_ms[slot] = elapsed;
+    bank->duration_ms[slot] = duration;
+    return changed;
 }
 
-const CreatureFrame* anim_current_frame(const AnimState* state) {
-    if (!state || !state->current) return NULL;
+u32 anim_bank_tick(AnimBank* bank, u64 now_ms) {
+    // The first tick only starts the clock
+    if (bank->last_ms == 0 || now_ms < bank->last_ms) {
+        bank->last_ms = now_ms;
+        return 0;
+    }
+    u64 step = now_ms - bank->last_ms;
+    bank->last_ms = now_ms;
+    if (step > ANIM_MAX_STEP_MS) step = ANIM_MAX_STEP_MS;
+
+    u32 changed = 0;
+    for (int i = 0; i < bank->count; i++) {
+        u32 elapsed = bank->elapsed_ms[i] + (u32)step;
+        bank->elapsed_ms[i] = elapsed;
+        u16 duration = bank->duration_ms[i];
+        if (duration != 0 && elapsed >= duration && advance_slot(bank, i)) {
+            changed |= BIT(i);
+        }
+    }
+    return changed;
+}
 
-    // For all clawd animations, use the actual clawd pixel data
-    // frame_index 0 = normal, frame_index 1 = raised
-    int idx = state->frame_index % 2;  // clawd only has 2 visual frames
-    return creature_get_clawd_frame(idx);
+const AnimKeyframe* anim_bank_key(const AnimBank* bank, int slot) {
+    if (!bank || slot < 0 || slot >= bank->count) return NULL;
+    const AnimDef* def = bank->current[slot];
+    if (!def || def->key_count == 0) return NULL;
+    return &def->keys[bank->frame_index[slot]];
 }
@@ -3,20 +3,42 @@
 
 #include <stdbool.h>
 #include "creature.h"
+#include "protocol.h"
 
+// One step of an animation. Offsets are in creature pixels (multiplied by
+// the draw scale); scale is relative and applied around the sprite's center.
 typedef struct {
-    const CreatureFrame* frames;
-    int frame_count;
-    int ticks_per_frame;   // e.g. 20 ticks = ~3Hz at 60fps
-    bool one_shot;         // for spawn animation — stops at last frame
+    SpriteId sprite;
+    s8 dx, dy;
+    float scale;           // 1.0 = normal size
+    u32 tint;              // ABGR, mixed in by blend
+    float blend;           // 0 = use the caller's tint (agent state)
+    u16 duration_ms;
+} AnimKeyframe;
+
+typedef struct {
+    const AnimKeyframe* keys;
+    int key_count;
+    bool one_shot;         // for spawn animation — ends at last keyframe
 } AnimDef;
 
+// One per agent slot; anim_bank_tick reports changes as a u32 slot mask
+#define ANIM_MAX_SLOTS MAX_AGENTS
+_Static_assert(ANIM_MAX_SLOTS <= 32, "anim_bank_tick's mask holds 32 slots");
+
+// Animation state of every creature slot, as parallel arrays advanced
+// together by anim_bank_tick. The per-frame pass only reads elapsed_ms and
+// duration_ms (the current keyframe's length); keyframe tables are touched
+// only when a slot moves to its next keyframe.
 typedef struct {
-    const AnimDef* current;
-    int frame_index;
-    int tick_counter;
-    bool finished;         // true when one_shot completes
-} AnimState;
+    u32 elapsed_ms[ANIM_MAX_SLOTS];      // time spent in the current keyframe
+    u16 duration_ms[ANIM_MAX_SLOTS];     // current keyframe length, 0 = hold
+    u8 frame_index[ANIM_MAX_SLOTS];      // current keyframe
+    const AnimDef* current[ANIM_MAX_SLOTS];
+    const AnimDef* next[ANIM_MAX_SLOTS]; // loop to start when a one-shot ends
+    int count;
+    u64 last_ms;           // osGetTime at the previous tick, 0 = not started
+} AnimBank;
 
 // Animation definitions for each agent state
 extern const AnimDef anim_idle;       // gentle bob ~3Hz
@@ -24,13 +46,24 @@ extern const AnimDef anim_working;    // pulse ~6Hz
 extern const AnimDef anim_waiting;    // urgent flash ~7.5Hz
 extern const AnimDef anim_spawn;      // pokeball one-shot ~1.5s
 
-// Advance animation by one tick (call once per frame at 60fps)
-void anim_tick(AnimState* state);
+// Set up count slots (at most ANIM_MAX_SLOTS), all playing def
+void anim_bank_init(AnimBank* bank, int count, const AnimDef* def);
+
+// Switch a slot to a looping animation. While a one-shot is playing it is
+// queued to start when the one-shot ends. Setting the current animation
+// again does nothing. Returns true if the slot changed now.
+bool anim_bank_set(AnimBank* bank, int slot, const AnimDef* def);
+
+// Play a one-shot on a slot now, then return to its looping animation
+void anim_bank_play(AnimBank* bank, int slot, const AnimDef* once);
 
-// Switch to a new animation definition, resetting state
-void anim_set(AnimState* state, const AnimDef* def);
+// Advance every slot to now_ms (osGetTime). Speed follows the clock, not
+// the frame rate, so skipped or slow frames don't slow animations down.
+// Returns a bitmask of slots whose displayed keyframe changed.
+u32 anim_bank_tick(AnimBank* bank, u64 now_ms);
 
-// Get the current frame to render
-const CreatureFrame* anim_current_frame(const AnimState* state);
+// Current keyframe of a slot to render (NULL if bank is NULL or the slot
+// has no animation)
+const AnimKeyframe* anim_bank_key(const AnimBank* bank, int slot);
 
 #endif // ANIMATION_H
@@ -270,6 +270,11 @@ CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
             global_hooks.deallocate(item->string);
             item->string = NULL;
         }
+        if (item->index != NULL)
+        {
+            global_hooks.deallocate(item->index);
+            item->index = NULL;
+        }
         global_hooks.deallocate(item);
         item = next;
     }
@@ -1933,6 +1938,120 @@ CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index)
     return get_array_item(array, (size_t)index);
 }
 
+/* Open addressed table of an object's children, keyed by name */
+typedef struct
+{
+    unsigned int hash;
+    cJSON *item; /* NULL if the slot is empty */
+} index_slot;
+
+struct cJSON_Index
+{
+    size_t mask; /* slot count - 1, a power of two at least twice the children */
+    index_slot slots[1];
+};
+
+/* FNV-1a */
+static unsigned int hash_key(const unsigned char *key)
+{
+    unsigned int hash = 2166136261u;
+    for (; *key != '\0'; key++)
+    {
+        hash = (hash ^ *key) * 16777619u;
+    }
+
+    return hash;
+}
+
+static void drop_index(cJSON * const object)
+{
+    if ((object != NULL) && (object->index != NULL))
+    {
+        global_hooks.deallocate(object->index);
+        object->index = NULL;
+    }
+}
+
+/* Index the children of an object that has enough of them. The first of
+ * several children with the same name wins, as in the list walk.
+ * Returns NULL if the object is too small or the allocation fails. */
+static struct cJSON_Index *build_index(cJSON * const object)
+{
+    struct cJSON_Index *index = NULL;
+    cJSON *child = NULL;
+    size_t count = 0;
+    size_t size = 1;
+
+    if ((CJSON_INDEX_MIN_ITEMS <= 0) || (object->type & cJSON_IsReference))
+    {
+        /* a reference shares its children with the object it points to */
+        return NULL;
+    }
+
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        count++;
+    }
+    if (count < (size_t)CJSON_INDEX_MIN_ITEMS)
+    {
+        return NULL;
+    }
+
+    while (size < count * 2)
+    {
+        size <<= 1;
+    }
+    index = (struct cJSON_Index*)global_hooks.allocate(sizeof(struct cJSON_Index) + (size - 1) * sizeof(index_slot));
+    if (index == NULL)
+    {
+        return NULL;
+    }
+    memset(index->slots, '\0', size * sizeof(index_slot));
+    index->mask = size - 1;
+
+    for (child = object->child; child != NULL; child = child->next)
+    {
+        unsigned int hash = 0;
+        size_t slot = 0;
+
+        if (child->string == NULL)
+        {
+            continue;
+        }
+        hash = hash_key((const unsigned char*)child->string);
+        for (slot = hash & index->mask; index->slots[slot].item != NULL; slot = (slot + 1) & index->mask)
+        {
+            if ((index->slots[slot].hash == hash) && (strcmp(index->slots[slot].item->string, child->string) == 0))
+            {
+                break;
+            }
+        }
+        if (index->slots[slot].item == NULL)
+        {
+            index->slots[slot].hash = hash;
+            index->slots[slot].item = child;
+        }
+    }
+
+    return index;
+}
+
+static cJSON *index_lookup(const struct cJSON_Index * const index, const char * const name)
+{
+    unsigned int hash = hash_key((const unsigned char*)name);
+    size_t slot = 0;
+
+    for (slot = hash & index->mask; index->slots[slot].item != NULL; slot = (slot + 1) & index->mask)
+    {
+        if ((index->slots[slot].hash == hash) && (strcmp(index->slots[slot].item->string, name) == 0))
+        {
+            return index->slots[slot].item;
+        }
+    }
+
+    return NULL;
+}
+
 static cJSON *get_object_item(const cJSON * const object, const char * const name, const cJSON_bool case_sensitive)
 {
     cJSON *current_element = NULL;
@@ -1942,6 +2061,20 @@ static cJSON *get_object_item(const cJSON * const object, const char * const nam
         return NULL;
     }
 
+    if (case_sensitive && cJSON_IsObject(object))
+    {
+        /* lookups don't change the object's contents, only its index */
+        cJSON *indexed = (cJSON*)object;
+        if (indexed->index == NULL)
+        {
+            indexed->index = build_index(indexed);
+        }
+        if (indexed->index != NULL)
+        {
+            return index_lookup(indexed->index, name);
+        }
+    }
+
     current_element = object->child;
     if (case_sensitive)
     {
@@ -2004,6 +2137,7 @@ static cJSON *create_reference(const cJSON *item, const internal_hooks * const h
 
     memcpy(reference, item, sizeof(cJSON));
     reference->string = NULL;
+    reference->index = NULL;
     reference->type |= cJSON_IsReference;
     reference->next = reference->prev = NULL;
     return reference;
@@ -2018,6 +2152,7 @@ static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
         return false;
     }
 
+    drop_index(array);
     child = array->child;
     /*
      * To find the last item in array quickly, we use prev in array
@@ -2247,6 +2382,8 @@ CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const it
         return NULL;
     }
 
+    drop_index(parent);
+
     if (item != parent->child)
     {
         /* not the first element */
@@ -2336,6 +2473,7 @@ CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON
         return false;
     }
 
+    drop_index(array);
     newitem->next = after_inserted;
     newitem->prev = after_inserted->prev;
     after_inserted->prev = newitem;
@@ -2362,6 +2500,7 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON
         return true;
     }
 
+    drop_index(parent);
     replacement->next = item->next;
     replacement->prev = item->prev;
 
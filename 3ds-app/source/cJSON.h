@@ -120,6 +120,9 @@ typedef struct cJSON
 
     /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
     char *string;
+
+    /* Hash index of an object's children, built on the first case sensitive lookup. Internal. */
+    struct cJSON_Index *index;
 } cJSON;
 
 typedef struct cJSON_Hooks
@@ -143,6 +146,13 @@ typedef int cJSON_bool;
 #define CJSON_CIRCULAR_LIMIT 10000
 #endif
 
+/* Objects with at least this many children get a hash index on their first
+ * cJSON_GetObjectItemCaseSensitive, so further lookups don't walk the list.
+ * Adding, removing or replacing children drops the index. 0 disables it. */
+#ifndef CJSON_INDEX_MIN_ITEMS
+#define CJSON_INDEX_MIN_ITEMS 16
+#endif
+
 /* returns the version of cJSON as a string */
 CJSON_PUBLIC(const char*) cJSON_Version(void);
 
@@ -0,0 +1,217 @@
+#include "codec.h"
+#include <string.h>
+
+typedef enum {
+    KIND_NONE = 0,
+    KIND_STRING,
+    KIND_INT,
+    KIND_BOOL,
+} FieldKind;
+
+static const unsigned char field_kinds[] = {
+    [FIELD_AGENT]              = KIND_STRING,
+    [FIELD_STATE]              = KIND_INT,
+    [FIELD_PROGRESS]           = KIND_INT,
+    [FIELD_MESSAGE]            = KIND_STRING,
+    [FIELD_PENDING_COMMAND]    = KIND_STRING,
+    [FIELD_CONTEXT_PERCENT]    = KIND_INT,
+    [FIELD_PROMPT_TOOL_TYPE]   = KIND_STRING,
+    [FIELD_PROMPT_TOOL_DETAIL] = KIND_STRING,
+    [FIELD_PROMPT_DESCRIPTION] = KIND_STRING,
+    [FIELD_SLOT]               = KIND_INT,
+    [FIELD_ACTIVE]             = KIND_BOOL,
+    [FIELD_AUTO_EDIT]          = KIND_BOOL,
+    [FIELD_SUCCESS]            = KIND_BOOL,
+    [FIELD_ERROR]              = KIND_STRING,
+    [FIELD_SEQ]                = KIND_INT,
+    [FIELD_ENTRY]              = KIND_NONE,   // see codec_batch_next
+    [FIELD_TRACE_ID]           = KIND_INT,
+    [FIELD_CLIENT_MS]          = KIND_INT,
+    [FIELD_SERVER_MS]          = KIND_INT,
+};
+
+#define FIELD_LIMIT ((int)(sizeof(field_kinds) / sizeof(field_kinds[0])))
+
+static WireString* string_field(WireMessage* msg, int key) {
+    switch (key) {
+        case FIELD_AGENT:              return &msg->agent;
+        case FIELD_MESSAGE:            return &msg->message;
+        case FIELD_PENDING_COMMAND:    return &msg->pending_command;
+        case FIELD_PROMPT_TOOL_TYPE:   return &msg->prompt_tool_type;
+        case FIELD_PROMPT_TOOL_DETAIL: return &msg->prompt_tool_detail;
+        case FIELD_PROMPT_DESCRIPTION: return &msg->prompt_description;
+        case FIELD_ERROR:              return &msg->error;
+        default:                       return NULL;
+    }
+}
+
+static int* int_field(WireMessage* msg, int key) {
+    switch (key) {
+        case FIELD_PROGRESS:        return &msg->progress;
+        case FIELD_CONTEXT_PERCENT: return &msg->context_percent;
+        case FIELD_SLOT:            return &msg->slot;
+        case FIELD_SEQ:             return &msg->seq;
+        case FIELD_TRACE_ID:        return &msg->trace_id;
+        case FIELD_CLIENT_MS:       return &msg->client_ms;
+        case FIELD_SERVER_MS:       return &msg->server_ms;
+        default:                    return NULL;
+    }
+}
+
+static bool* bool_field(WireMessage* msg, int key) {
+    switch (key) {
+        case FIELD_ACTIVE:    return &msg->active;
+        case FIELD_AUTO_EDIT: return &msg->auto_edit;
+        case FIELD_SUCCESS:   return &msg->success;
+        default:              return NULL;
+    }
+}
+
+static bool read_varint(const unsigned char* data, int len, int* pos, unsigned int* out) {
+    unsigned int value = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        if (*pos >= len) return false;
+        unsigned char b = data[(*pos)++];
+        value |= (unsigned int)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *out = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool read_int(const unsigned char* v, int n, int* out) {
+    switch (n) {
+        case 1: *out = (signed char)v[0]; return true;
+        case 2: *out = (short)(v[0] | (v[1] << 8)); return true;
+        case 4: *out = (int)((unsigned int)v[0] | ((unsigned int)v[1] << 8) |
+                             ((unsigned int)v[2] << 16) | ((unsigned int)v[3] << 24));
+                return true;
+        default: return false;
+    }
+}
+
+bool codec_decode(const unsigned char* data, int len, WireMessage* msg) {
+    memset(msg, 0, sizeof(*msg));
+    if (len < 2 || data[0] != WIRE_VERSION) return false;
+
+    msg->type = (MessageType)data[1];
+    int pos = 2;
+
+    while (pos < len) {
+        int key = data[pos++];
+        unsigned int vlen;
+        if (!read_varint(data, len, &pos, &vlen)) return false;
+        if (vlen > (unsigned int)(len - pos)) return false;
+        const unsigned char* value = data + pos;
+        pos += vlen;
+
+        if (key >= FIELD_LIMIT) continue;
+
+        int n;
+        switch (field_kinds[key]) {
+            case KIND_STRING: {
+                WireString* s = string_field(msg, key);
+                s->str = (const char*)value;
+                s->len = (int)vlen;
+                break;
+            }
+            case KIND_INT:
+                if (!read_int(value, vlen, &n)) return false;
+                if (key == FIELD_STATE) {
+                    msg->state = (n >= STATE_IDLE && n <= STATE_DONE) ? (AgentState)n : STATE_IDLE;
+                } else {
+                    *int_field(msg, key) = n;
+                }
+                break;
+            case KIND_BOOL:
+                if (vlen != 1) return false;
+                *bool_field(msg, key) = value[0] != 0;
+                break;
+            default:
+                continue;
+        }
+        msg->present |= FIELD_BIT(key);
+    }
+    return true;
+}
+
+bool codec_batch_next(const unsigned char* data, int len, int* pos,
+                      const unsigned char** entry, int* entry_len) {
+    if (*pos == 0) {
+        if (len < 2 || data[0] != WIRE_VERSION || data[1] != MSG_SLOT_BATCH) return false;
+        *pos = 2;
+    }
+
+    while (*pos < len) {
+        int key = data[(*pos)++];
+        unsigned int vlen;
+        if (!read_varint(data, len, pos, &vlen)) return false;
+        if (vlen > (unsigned int)(len - *pos)) return false;
+        const unsigned char* value = data + *pos;
+        *pos += vlen;
+
+        if (key == FIELD_ENTRY) {
+            *entry = value;
+            *entry_len = (int)vlen;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int write_varint(unsigned char* out, int cap, int pos, unsigned int value) {
+    do {
+        if (pos >= cap) return -1;
+        unsigned char b = value & 0x7F;
+        value >>= 7;
+        out[pos++] = b | (value ? 0x80 : 0);
+    } while (value);
+    return pos;
+}
+
+static int write_field(unsigned char* out, int cap, int pos, int key,
+                       const void* value, int vlen) {
+    if (pos >= cap) return -1;
+    out[pos++] = key;
+    pos = write_varint(out, cap, pos, vlen);
+    if (pos < 0 || vlen > cap - pos) return -1;
+    memcpy(out + pos, value, vlen);
+    return pos + vlen;
+}
+
+int codec_encode(const WireMessage* msg, unsigned char* out, int cap) {
+    if (cap < 2) return -1;
+    out[0] = WIRE_VERSION;
+    out[1] = (unsigned char)msg->type;
+    int pos = 2;
+
+    WireMessage* m = (WireMessage*)msg;  // accessors are shared with the decoder
+    for (int key = 1; key < FIELD_LIMIT && pos >= 0; key++) {
+        if (!(msg->present & FIELD_BIT(key))) continue;
+
+        switch (field_kinds[key]) {
+            case KIND_STRING: {
+                const WireString* s = string_field(m, key);
+                pos = write_field(out, cap, pos, key, s->str, s->len);
+                break;
+            }
+            case KIND_INT: {
+                int n = (key == FIELD_STATE) ? (int)msg->state : *int_field(m, key);
+                unsigned char v[4] = { n & 0xFF, (n >> 8) & 0xFF, (n >> 16) & 0xFF, (n >> 24) & 0xFF };
+                int vlen = (n >= -128 && n <= 127) ? 1 : (n >= -32768 && n <= 32767) ? 2 : 4;
+                pos = write_field(out, cap, pos, key, v, vlen);
+                break;
+            }
+            case KIND_BOOL: {
+                unsigned char v = *bool_field(m, key) ? 1 : 0;
+                pos = write_field(out, cap, pos, key, &v, 1);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return pos;
+}
@@ -0,0 +1,32 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include "protocol.h"
+
+// Compact binary encoding of server messages, sent as WebSocket binary
+// frames to clients that negotiate the "raids-bin" subprotocol.
+//
+//   [version:u8] [type:u8] { [key:u8] [len:varint] [value:len bytes] }*
+//
+// Strings are raw UTF-8, integers are little-endian two's complement in
+// 1, 2 or 4 bytes, booleans are one byte. Unknown keys are skipped.
+// Mirrors companion-server/src/codec.ts.
+
+#define WIRE_VERSION 1
+#define WIRE_SUBPROTOCOL "raids-bin"
+
+// Decode a binary message. Strings in msg point into data.
+// Returns false if the message is malformed or of another version.
+bool codec_decode(const unsigned char* data, int len, WireMessage* msg);
+
+// Iterate the entries of a MSG_SLOT_BATCH message, each a complete encoded
+// message for codec_decode. Start with *pos = 0. Returns false once there
+// are no more entries or the batch is malformed.
+bool codec_batch_next(const unsigned char* data, int len, int* pos,
+                      const unsigned char** entry, int* entry_len);
+
+// Encode the present fields of msg. Returns the encoded length,
+// or -1 if it does not fit in cap.
+int codec_encode(const WireMessage* msg, unsigned char* out, int cap);
+
+#endif // CODEC_H
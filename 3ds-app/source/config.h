@@ -10,4 +10,16 @@
 
 #define SERVER_PORT 3333
 
+// Ask the server for the compact binary encoding (codec.h).
+// Servers that don't support it keep sending JSON, which is always accepted.
+#ifndef PROTOCOL_BINARY
+#define PROTOCOL_BINARY 1
+#endif
+
+// Show the round trip of the last action (button press to keystrokes sent
+// and acknowledged) with its p95 in the top screen title bar
+#ifndef SHOW_LATENCY
+#define SHOW_LATENCY 0
+#endif
+
 #endif // CONFIG_H
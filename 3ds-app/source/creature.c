@@ -1,5 +1,6 @@
 #include "creature.h"
 #include <citro2d.h>
+#include <string.h>
 
 // Catppuccin Mocha palette colors for Clawd
 #define CLR_TRANSPARENT 0x00000000
@@ -10,74 +11,303 @@
 #define CLR_CLAW    0xFFF78BA6  // Mauve-ish for claw tips
 #define CLR_ANTENNA 0xFFF7A6CB  // Mauve #cba6f7
 
-// Shorthand
-#define __ CLR_TRANSPARENT
-#define BB CLR_BODY
-#define DD CLR_DARK
-#define EE CLR_EYE
-#define LL CLR_LIGHT
-#define CC CLR_CLAW
-#define AA CLR_ANTENNA
+// Pokeball and spawn flash
+#define CLR_BALL_RED   0xFFA88BF3  // Red #f38ba8
+#define CLR_BALL_WHITE 0xFFF4D6CD  // Text #cdd6f4
+#define CLR_SHINE      0xFFFFFFFF
+#define CLR_FLASH      0xFFAFE2F9  // Yellow #f9e2af
+
+// Clawd's palette; frames below index into it
+static const CreaturePalette clawd_palette = {
+    .colors = { CLR_TRANSPARENT, CLR_BODY, CLR_DARK, CLR_EYE, CLR_LIGHT, CLR_CLAW, CLR_ANTENNA },
+    .count = 7,
+};
+
+// Shorthand (palette indices)
+#define __ 0
+#define BB 1
+#define DD 2
+#define EE 3
+#define LL 4
+#define CC 5
+#define AA 6
+
+// One row of 16 palette indices, packed two per byte
+#define PACK2(a, b) (u8)((a) | ((b) << 4))
+#define ROW(p0, p1, p2, p3, p4, p5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15) \
+    { PACK2(p0, p1), PACK2(p2, p3), PACK2(p4, p5), PACK2(p6, p7),             \
+      PACK2(p8, p9), PACK2(p10, p11), PACK2(p12, p13), PACK2(p14, p15) }
 
 // Clawd frame 0: normal pose
 // Crab-like creature inspired by Claude's TUI crab
-static const CreatureFrame clawd_frame0 = { .pixels = {
+static const CreatureFrame clawd_frame0 = { .palette = &clawd_palette, .indices = {
 //   0   1   2   3   4   5   6   7   8   9  10  11  12  13  14  15
-    {__, __, __, AA, __, __, __, __, __, __, __, __, AA, __, __, __},  // 0: antenna tips
-    {__, __, __, DD, AA, __, __, __, __, __, __, AA, DD, __, __, __},  // 1: antenna stalks
-    {__, __, __, __, DD, __, __, __, __, __, __, DD, __, __, __, __},  // 2: antenna base
-    {__, __, __, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, __, __, __},  // 3: body top border
-    {__, __, DD, BB, BB, EE, EE, BB, BB, EE, EE, BB, BB, DD, __, __},  // 4: body with eyes
-    {__, CC, DD, BB, BB, EE, EE, BB, BB, EE, EE, BB, BB, DD, CC, __},  // 5: body + arm nubs
-    {__, CC, DD, BB, BB, BB, LL, LL, LL, LL, BB, BB, BB, DD, CC, __},  // 6: body belly
-    {__, __, DD, BB, BB, BB, LL, LL, LL, LL, BB, BB, BB, DD, __, __},  // 7: body belly
-    {__, __, DD, BB, BB, BB, BB, BB, BB, BB, BB, BB, BB, DD, __, __},  // 8: body lower
-    {__, __, __, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, __, __, __},  // 9: body bottom border
-    {__, __, DD, DD, __, __, __, __, __, __, __, __, DD, DD, __, __},  // 10: upper legs
-    {__, DD, DD, __, __, __, __, __, __, __, __, __, __, DD, DD, __},  // 11: legs spread
-    {__, DD, __, __, __, DD, DD, __, __, DD, DD, __, __, __, DD, __},  // 12: legs + inner legs
-    {DD, DD, __, __, DD, DD, __, __, __, __, DD, DD, __, __, DD, DD},  // 13: feet spreading
-    {CC, __, __, __, CC, __, __, __, __, __, __, CC, __, __, __, CC},  // 14: claw feet
-    {__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __},  // 15: empty
+    ROW(__, __, __, AA, __, __, __, __, __, __, __, __, AA, __, __, __),  // 0: antenna tips
+    ROW(__, __, __, DD, AA, __, __, __, __, __, __, AA, DD, __, __, __),  // 1: antenna stalks
+    ROW(__, __, __, __, DD, __, __, __, __, __, __, DD, __, __, __, __),  // 2: antenna base
+    ROW(__, __, __, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, __, __, __),  // 3: body top border
+    ROW(__, __, DD, BB, BB, EE, EE, BB, BB, EE, EE, BB, BB, DD, __, __),  // 4: body with eyes
+    ROW(__, CC, DD, BB, BB, EE, EE, BB, BB, EE, EE, BB, BB, DD, CC, __),  // 5: body + arm nubs
+    ROW(__, CC, DD, BB, BB, BB, LL, LL, LL, LL, BB, BB, BB, DD, CC, __),  // 6: body belly
+    ROW(__, __, DD, BB, BB, BB, LL, LL, LL, LL, BB, BB, BB, DD, __, __),  // 7: body belly
+    ROW(__, __, DD, BB, BB, BB, BB, BB, BB, BB, BB, BB, BB, DD, __, __),  // 8: body lower
+    ROW(__, __, __, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, __, __, __),  // 9: body bottom border
+    ROW(__, __, DD, DD, __, __, __, __, __, __, __, __, DD, DD, __, __),  // 10: upper legs
+    ROW(__, DD, DD, __, __, __, __, __, __, __, __, __, __, DD, DD, __),  // 11: legs spread
+    ROW(__, DD, __, __, __, DD, DD, __, __, DD, DD, __, __, __, DD, __),  // 12: legs + inner legs
+    ROW(DD, DD, __, __, DD, DD, __, __, __, __, DD, DD, __, __, DD, DD),  // 13: feet spreading
+    ROW(CC, __, __, __, CC, __, __, __, __, __, __, CC, __, __, __, CC),  // 14: claw feet
+    ROW(__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __),  // 15: empty
 }};
 
 // Clawd frame 1: raised 1px (bob animation — shift body up 1 row)
-static const CreatureFrame clawd_frame1 = { .pixels = {
-    {__, __, __, AA, __, __, __, __, __, __, __, __, AA, __, __, __},  // 0: antenna (was row -1, clip)
-    {__, __, __, __, DD, __, __, __, __, __, __, DD, __, __, __, __},  // 1
-    {__, __, __, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, __, __, __},  // 2
-    {__, __, DD, BB, BB, EE, EE, BB, BB, EE, EE, BB, BB, DD, __, __},  // 3
-    {__, CC, DD, BB, BB, EE, EE, BB, BB, EE, EE, BB, BB, DD, CC, __},  // 4
-    {__, CC, DD, BB, BB, BB, LL, LL, LL, LL, BB, BB, BB, DD, CC, __},  // 5
-    {__, __, DD, BB, BB, BB, LL, LL, LL, LL, BB, BB, BB, DD, __, __},  // 6
-    {__, __, DD, BB, BB, BB, BB, BB, BB, BB, BB, BB, BB, DD, __, __},  // 7
-    {__, __, __, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, __, __, __},  // 8
-    {__, __, DD, DD, __, __, __, __, __, __, __, __, DD, DD, __, __},  // 9
-    {__, DD, DD, __, __, __, __, __, __, __, __, __, __, DD, DD, __},  // 10
-    {__, DD, __, __, __, DD, DD, __, __, DD, DD, __, __, __, DD, __},  // 11
-    {DD, DD, __, __, DD, DD, __, __, __, __, DD, DD, __, __, DD, DD},  // 12
-    {CC, __, __, __, CC, __, __, __, __, __, __, CC, __, __, __, CC},  // 13
-    {__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __},  // 14
-    {__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __},  // 15
+static const CreatureFrame clawd_frame1 = { .palette = &clawd_palette, .indices = {
+    ROW(__, __, __, AA, __, __, __, __, __, __, __, __, AA, __, __, __),  // 0: antenna (was row -1, clip)
+    ROW(__, __, __, __, DD, __, __, __, __, __, __, DD, __, __, __, __),  // 1
+    ROW(__, __, __, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, __, __, __),  // 2
+    ROW(__, __, DD, BB, BB, EE, EE, BB, BB, EE, EE, BB, BB, DD, __, __),  // 3
+    ROW(__, CC, DD, BB, BB, EE, EE, BB, BB, EE, EE, BB, BB, DD, CC, __),  // 4
+    ROW(__, CC, DD, BB, BB, BB, LL, LL, LL, LL, BB, BB, BB, DD, CC, __),  // 5
+    ROW(__, __, DD, BB, BB, BB, LL, LL, LL, LL, BB, BB, BB, DD, __, __),  // 6
+    ROW(__, __, DD, BB, BB, BB, BB, BB, BB, BB, BB, BB, BB, DD, __, __),  // 7
+    ROW(__, __, __, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, __, __, __),  // 8
+    ROW(__, __, DD, DD, __, __, __, __, __, __, __, __, DD, DD, __, __),  // 9
+    ROW(__, DD, DD, __, __, __, __, __, __, __, __, __, __, DD, DD, __),  // 10
+    ROW(__, DD, __, __, __, DD, DD, __, __, DD, DD, __, __, __, DD, __),  // 11
+    ROW(DD, DD, __, __, DD, DD, __, __, __, __, DD, DD, __, __, DD, DD),  // 12
+    ROW(CC, __, __, __, CC, __, __, __, __, __, __, CC, __, __, __, CC),  // 13
+    ROW(__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __),  // 14
+    ROW(__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __),  // 15
+}};
+
+
+// Pokeball palette; DD is shared with Clawd's so the outline shorthand works
+static const CreaturePalette ball_palette = {
+    .colors = { CLR_TRANSPARENT, CLR_BALL_RED, CLR_DARK, CLR_BALL_WHITE, CLR_SHINE, CLR_FLASH },
+    .count = 6,
+};
+
+#define RR 1
+#define WW 3
+#define HH 4
+#define YY 5
+
+// Closed pokeball
+static const CreatureFrame ball_closed = { .palette = &ball_palette, .indices = {
+    ROW(__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __),  // 0
+    ROW(__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __),  // 1
+    ROW(__, __, __, __, __, DD, DD, DD, DD, DD, DD, __, __, __, __, __),  // 2
+    ROW(__, __, __, DD, DD, RR, RR, RR, RR, RR, RR, DD, DD, __, __, __),  // 3
+    ROW(__, __, DD, RR, RR, HH, RR, RR, RR, RR, RR, RR, RR, DD, __, __),  // 4
+    ROW(__, __, DD, RR, HH, RR, RR, RR, RR, RR, RR, RR, RR, DD, __, __),  // 5
+    ROW(__, DD, RR, RR, RR, RR, DD, DD, DD, DD, RR, RR, RR, RR, DD, __),  // 6
+    ROW(__, DD, DD, DD, DD, DD, DD, HH, HH, DD, DD, DD, DD, DD, DD, __),  // 7
+    ROW(__, DD, DD, DD, DD, DD, DD, HH, HH, DD, DD, DD, DD, DD, DD, __),  // 8
+    ROW(__, DD, WW, WW, WW, WW, DD, DD, DD, DD, WW, WW, WW, WW, DD, __),  // 9
+    ROW(__, __, DD, WW, WW, WW, WW, WW, WW, WW, WW, WW, WW, DD, __, __),  // 10
+    ROW(__, __, DD, WW, WW, WW, WW, WW, WW, WW, WW, WW, WW, DD, __, __),  // 11
+    ROW(__, __, __, DD, DD, WW, WW, WW, WW, WW, WW, DD, DD, __, __, __),  // 12
+    ROW(__, __, __, __, __, DD, DD, DD, DD, DD, DD, __, __, __, __, __),  // 13
+    ROW(__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __),  // 14
+    ROW(__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __),  // 15
+}};
+
+// Pokeball split open, light escaping
+static const CreatureFrame ball_open = { .palette = &ball_palette, .indices = {
+    ROW(__, __, __, __, __, DD, DD, DD, DD, DD, DD, __, __, __, __, __),  // 0
+    ROW(__, __, __, DD, DD, RR, RR, RR, RR, RR, RR, DD, DD, __, __, __),  // 1
+    ROW(__, __, DD, RR, RR, HH, RR, RR, RR, RR, RR, RR, RR, DD, __, __),  // 2
+    ROW(__, __, DD, RR, HH, RR, RR, RR, RR, RR, RR, RR, RR, DD, __, __),  // 3
+    ROW(__, DD, RR, RR, RR, RR, RR, RR, RR, RR, RR, RR, RR, RR, DD, __),  // 4
+    ROW(__, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, __),  // 5
+    ROW(__, __, __, YY, YY, YY, YY, YY, YY, YY, YY, YY, YY, __, __, __),  // 6
+    ROW(__, __, YY, YY, YY, YY, HH, HH, HH, HH, YY, YY, YY, YY, __, __),  // 7
+    ROW(__, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, DD, __),  // 8
+    ROW(__, DD, WW, WW, WW, WW, WW, WW, WW, WW, WW, WW, WW, WW, DD, __),  // 9
+    ROW(__, __, DD, WW, WW, WW, WW, WW, WW, WW, WW, WW, WW, DD, __, __),  // 10
+    ROW(__, __, DD, WW, WW, WW, WW, WW, WW, WW, WW, WW, WW, DD, __, __),  // 11
+    ROW(__, __, __, DD, DD, WW, WW, WW, WW, WW, WW, DD, DD, __, __, __),  // 12
+    ROW(__, __, __, __, __, DD, DD, DD, DD, DD, DD, __, __, __, __, __),  // 13
+    ROW(__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __),  // 14
+    ROW(__, __, __, __, __, __, __, __, __, __, __, __, __, __, __, __),  // 15
 }};
 
+// Burst of light as the creature comes out
+static const CreatureFrame spawn_flash = { .palette = &ball_palette, .indices = {
+    ROW(__, __, __, __, __, __, __, HH, HH, __, __, __, __, __, __, __),  // 0
+    ROW(__, __, __, __, __, __, __, YY, YY, __, __, __, __, __, __, __),  // 1
+    ROW(__, __, HH, __, __, __, __, YY, YY, __, __, __, __, HH, __, __),  // 2
+    ROW(__, __, __, YY, __, __, __, YY, YY, __, __, __, YY, __, __, __),  // 3
+    ROW(__, __, __, __, YY, __, YY, HH, HH, YY, __, YY, __, __, __, __),  // 4
+    ROW(__, __, __, __, __, YY, HH, HH, HH, HH, YY, __, __, __, __, __),  // 5
+    ROW(__, __, __, __, YY, HH, HH, HH, HH, HH, HH, YY, __, __, __, __),  // 6
+    ROW(HH, YY, YY, YY, HH, HH, HH, HH, HH, HH, HH, HH, YY, YY, YY, HH),  // 7
+    ROW(HH, YY, YY, YY, HH, HH, HH, HH, HH, HH, HH, HH, YY, YY, YY, HH),  // 8
+    ROW(__, __, __, __, YY, HH, HH, HH, HH, HH, HH, YY, __, __, __, __),  // 9
+    ROW(__, __, __, __, __, YY, HH, HH, HH, HH, YY, __, __, __, __, __),  // 10
+    ROW(__, __, __, __, YY, __, YY, HH, HH, YY, __, YY, __, __, __, __),  // 11
+    ROW(__, __, __, YY, __, __, __, YY, YY, __, __, __, YY, __, __, __),  // 12
+    ROW(__, __, HH, __, __, __, __, YY, YY, __, __, __, __, HH, __, __),  // 13
+    ROW(__, __, __, __, __, __, __, YY, YY, __, __, __, __, __, __, __),  // 14
+    ROW(__, __, __, __, __, __, __, HH, HH, __, __, __, __, __, __, __),  // 15
+}};
 
-const CreatureFrame* creature_get_clawd_frame(int frame_index) {
-    if (frame_index <= 0) return &clawd_frame0;
-    return &clawd_frame1;
+static const CreatureFrame* const sprite_frames[SPRITE_COUNT] = {
+    [SPRITE_CLAWD]        = &clawd_frame0,
+    [SPRITE_CLAWD_RAISED] = &clawd_frame1,
+    [SPRITE_BALL]         = &ball_closed,
+    [SPRITE_BALL_OPEN]    = &ball_open,
+    [SPRITE_FLASH]        = &spawn_flash,
+};
+
+const CreatureFrame* creature_get_frame(SpriteId sprite) {
+    if (sprite < 0 || sprite >= SPRITE_COUNT) return NULL;
+    return sprite_frames[sprite];
 }
 
-void draw_creature(float x, float y, int scale, const CreatureFrame* frame) {
-    if (!frame) return;
+static int palette_find_or_add(CreaturePalette* palette, u32 color) {
+    if ((color >> 24) == 0) return 0;  // any fully transparent pixel
+    if (palette->count == 0) {
+        palette->colors[0] = CLR_TRANSPARENT;
+        palette->count = 1;
+    }
+    for (int i = 1; i < palette->count; i++) {
+        if (palette->colors[i] == color) return i;
+    }
+    if (palette->count == CREATURE_PALETTE_SIZE) return -1;
+    palette->colors[palette->count] = color;
+    return palette->count++;
+}
 
+bool creature_pack(const u32 pixels[CREATURE_SIZE_H][CREATURE_W],
+                   CreaturePalette* palette, CreatureFrame* out) {
+    memset(out->indices, 0, sizeof(out->indices));
+    out->palette = palette;
     for (int row = 0; row < CREATURE_SIZE_H; row++) {
         for (int col = 0; col < CREATURE_W; col++) {
-            u32 color = frame->pixels[row][col];
-            if (color == CLR_TRANSPARENT) continue;
+            int index = palette_find_or_add(palette, pixels[row][col]);
+            if (index < 0) return false;
+            out->indices[row][col >> 1] |= (u8)(index << ((col & 1) * 4));
+        }
+    }
+    return true;
+}
+
+// ========== Sprite textures ==========
+// Each frame is uploaded once as a 16x16 RGBA8 texture with nearest
+// filtering, so a creature is one C2D_DrawImageAt at any scale instead of
+// a rect per opaque pixel.
+
+typedef struct {
+    const CreatureFrame* frame;
+    C3D_Tex tex;
+    C2D_Image image;
+    bool loaded;
+} CreatureSprite;
 
-            float px = x + col * scale;
-            float py = y + row * scale;
-            C2D_DrawRectSolid(px, py, 0, (float)scale, (float)scale, color);
+static CreatureSprite sprites[SPRITE_COUNT];
+
+// Whole texture, with the image top at v=1
+static const Tex3DS_SubTexture sprite_subtex = {
+    CREATURE_W, CREATURE_SIZE_H, 0.0f, 1.0f, 1.0f, 0.0f
+};
+
+// Texel offset in the GPU's tiled layout: 8x8 tiles, Morton order inside
+static u32 tiled_offset(u32 x, u32 y, u32 width) {
+    u32 mx = x & 7, my = y & 7;
+    mx = (mx | (mx << 2)) & 0x13;
+    mx = (mx | (mx << 1)) & 0x15;
+    my = (my | (my << 2)) & 0x13;
+    my = (my | (my << 1)) & 0x15;
+    return ((y >> 3) * (width >> 3) + (x >> 3)) * 64 + (mx | (my << 1));
+}
+
+static bool upload_sprite(CreatureSprite* sprite, const CreatureFrame* frame) {
+    if (!C3D_TexInit(&sprite->tex, CREATURE_W, CREATURE_SIZE_H, GPU_RGBA8)) return false;
+    C3D_TexSetFilter(&sprite->tex, GPU_NEAREST, GPU_NEAREST);
+
+    // Frame colors are ABGR; RGBA8 texels are RGBA. Texture row 0 is the
+    // bottom of the image.
+    u32* texels = sprite->tex.data;
+    for (int row = 0; row < CREATURE_SIZE_H; row++) {
+        for (int col = 0; col < CREATURE_W; col++) {
+            u32 ty = CREATURE_SIZE_H - 1 - row;
+            texels[tiled_offset(col, ty, CREATURE_W)] = __builtin_bswap32(creature_pixel(frame, row, col));
+        }
+    }
+    C3D_TexFlush(&sprite->tex);
+
+    sprite->frame = frame;
+    sprite->image.tex = &sprite->tex;
+    sprite->image.subtex = &sprite_subtex;
+    sprite->loaded = true;
+    return true;
+}
+
+bool creature_init(void) {
+    bool ok = true;
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        if (!sprites[i].loaded && !upload_sprite(&sprites[i], sprite_frames[i])) ok = false;
+    }
+    return ok;
+}
+
+void creature_exit(void) {
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        if (!sprites[i].loaded) continue;
+        C3D_TexDelete(&sprites[i].tex);
+        sprites[i].loaded = false;
+    }
+}
+
+static const CreatureSprite* find_sprite(const CreatureFrame* frame) {
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        if (sprites[i].loaded && sprites[i].frame == frame) return &sprites[i];
+    }
+    return NULL;
+}
+
+// Mix tint into an ABGR color by blend (0..1), alpha unchanged
+static u32 blend_color(u32 color, u32 tint, float blend) {
+    u32 out = color & 0xFF000000;
+    for (int shift = 0; shift < 24; shift += 8) {
+        float c = (color >> shift) & 0xFF;
+        float t = (tint >> shift) & 0xFF;
+        out |= (u32)(c + (t - c) * blend) << shift;
+    }
+    return out;
+}
+
+void draw_creature_tinted(float x, float y, float scale, const CreatureFrame* frame,
+                          u32 tint, float blend) {
+    if (!frame) return;
+
+    const CreatureSprite* sprite = find_sprite(frame);
+    if (sprite) {
+        C2D_ImageTint image_tint;
+        C2D_PlainImageTint(&image_tint, tint, blend);
+        C2D_DrawImageAt(sprite->image, x, y, 0, &image_tint, scale, scale);
+        return;
+    }
+
+    // No texture (creature_init failed or not called): one rect per
+    // horizontal run of the same palette index
+    for (int row = 0; row < CREATURE_SIZE_H; row++) {
+        int col = 0;
+        while (col < CREATURE_W) {
+            int index = creature_index(frame, row, col);
+            int start = col;
+            while (col < CREATURE_W && creature_index(frame, row, col) == index) col++;
+            if (index == 0) continue;
+
+            u32 color = frame->palette->colors[index];
+            if (blend > 0) color = blend_color(color, tint, blend);
+            C2D_DrawRectSolid(x + start * scale, y + row * scale, 0,
+                              (col - start) * scale, scale, color);
         }
     }
 }
+
+void draw_creature(float x, float y, float scale, const CreatureFrame* frame) {
+    draw_creature_tinted(x, y, scale, frame, 0, 0.0f);
+}
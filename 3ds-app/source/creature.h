@@ -6,15 +6,65 @@
 #define CREATURE_W 16
 #define CREATURE_SIZE_H 16
 
+#define CREATURE_PALETTE_SIZE 16   // 4-bit indices
+
+// Colors (ABGR) shared by a creature's frames. Index 0 is transparent.
+typedef struct {
+    u32 colors[CREATURE_PALETTE_SIZE];
+    int count;
+} CreaturePalette;
+
+// 16x16 frame as 4-bit palette indices, two per byte (low nibble = left
+// pixel): 128 bytes instead of 1 KB of u32 colors.
 typedef struct {
-    u32 pixels[CREATURE_SIZE_H][CREATURE_W];
+    const CreaturePalette* palette;
+    u8 indices[CREATURE_SIZE_H][CREATURE_W / 2];
 } CreatureFrame;
 
-// Get the idle frame for Clawd (frame 0 = normal, frame 1 = raised 1px)
-const CreatureFrame* creature_get_clawd_frame(int frame_index);
+static inline int creature_index(const CreatureFrame* frame, int row, int col) {
+    u8 pair = frame->indices[row][col >> 1];
+    return (col & 1) ? (pair >> 4) : (pair & 0x0F);
+}
+
+static inline u32 creature_pixel(const CreatureFrame* frame, int row, int col) {
+    return frame->palette->colors[creature_index(frame, row, col)];
+}
+
+// Convert a full-color frame (ABGR, alpha 0 = transparent) to indices into
+// palette, adding colors it doesn't have yet; frames of one creature can
+// share a palette this way. out->palette is set to palette.
+// Returns false if the palette would need more than 16 entries.
+bool creature_pack(const u32 pixels[CREATURE_SIZE_H][CREATURE_W],
+                   CreaturePalette* palette, CreatureFrame* out);
+
+// Every sprite the animations can show
+typedef enum {
+    SPRITE_CLAWD,          // Clawd, normal pose
+    SPRITE_CLAWD_RAISED,   // Clawd raised 1px (bob)
+    SPRITE_BALL,           // closed pokeball
+    SPRITE_BALL_OPEN,      // pokeball split open
+    SPRITE_FLASH,          // spawn light burst
+    SPRITE_COUNT
+} SpriteId;
+
+// Frame data for a sprite (NULL if out of range)
+const CreatureFrame* creature_get_frame(SpriteId sprite);
+
+// Upload every creature frame as a sprite texture (call once after C2D_Init).
+// Returns false if a texture could not be allocated; those frames are then
+// drawn pixel by pixel.
+bool creature_init(void);
+
+// Free the sprite textures
+void creature_exit(void);
 
 // Draw a creature at screen position (x,y) with pixel scale
-// Each pixel becomes scale x scale screen pixels
-void draw_creature(float x, float y, int scale, const CreatureFrame* frame);
+// Each pixel becomes scale x scale screen pixels. Uses the frame's sprite
+// texture, or one rect per horizontal run of a color if it has none.
+void draw_creature(float x, float y, float scale, const CreatureFrame* frame);
+
+// Same, with tint (ABGR) mixed into every pixel by blend (0 = none, 1 = solid)
+void draw_creature_tinted(float x, float y, float scale, const CreatureFrame* frame,
+                          u32 tint, float blend);
 
 #endif // CREATURE_H_
@@ -0,0 +1,62 @@
+#include "json_arena.h"
+#include <stdlib.h>
+
+// Holds a full-party batch of prompt-sized agent_status messages (about
+// 600 B of nodes and strings each with the 3DS's 32-bit pointers)
+#define JSON_ARENA_SIZE  (16 * 1024)
+#define JSON_ARENA_ALIGN 8
+
+static unsigned char arena[JSON_ARENA_SIZE] __attribute__((aligned(JSON_ARENA_ALIGN)));
+static size_t arena_used = 0;
+static unsigned int heap_live = 0;   // fallback allocations not yet freed
+static bool installed = false;
+static JsonArenaStats stats;
+
+static bool in_arena(const void* ptr) {
+    return (const unsigned char*)ptr >= arena && (const unsigned char*)ptr < arena + JSON_ARENA_SIZE;
+}
+
+static void* arena_malloc(size_t size) {
+    size_t start = (arena_used + JSON_ARENA_ALIGN - 1) & ~(size_t)(JSON_ARENA_ALIGN - 1);
+    if (start <= JSON_ARENA_SIZE && size <= JSON_ARENA_SIZE - start) {
+        arena_used = start + size;
+        stats.arena_allocs++;
+        return arena + start;
+    }
+    void* ptr = malloc(size);
+    if (ptr) {
+        heap_live++;
+        stats.heap_allocs++;
+    }
+    return ptr;
+}
+
+// Arena memory is only reclaimed by json_arena_release
+static void arena_free(void* ptr) {
+    if (ptr == NULL || in_arena(ptr)) return;
+    heap_live--;
+    free(ptr);
+}
+
+void json_arena_install(void) {
+    cJSON_Hooks hooks = { arena_malloc, arena_free };
+    cJSON_InitHooks(&hooks);
+    installed = true;
+}
+
+cJSON* json_arena_parse(const char* json, size_t len) {
+    if (!installed) json_arena_install();
+    stats.parses++;
+    return cJSON_ParseWithLength(json, len);
+}
+
+void json_arena_release(cJSON* root) {
+    // A tree entirely in the arena needs no walk; only heap fallbacks do
+    if (root && heap_live > 0) cJSON_Delete(root);
+    if (arena_used > stats.high_water) stats.high_water = arena_used;
+    arena_used = 0;
+}
+
+const JsonArenaStats* json_arena_get_stats(void) {
+    return &stats;
+}
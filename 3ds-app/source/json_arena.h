@@ -0,0 +1,37 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "cJSON.h"
+
+// cJSON allocations for one message come from a fixed bump arena instead of
+// the heap, and are all dropped at once when the message is done. Nothing
+// is freed node by node and the 3DS heap doesn't fragment over a long
+// session. Allocations that don't fit fall back to malloc.
+//
+// Only one message may be parsed at a time (the thread running the
+// connection owns it).
+
+typedef struct {
+    unsigned int parses;          // json_arena_parse calls
+    unsigned int arena_allocs;    // allocations served by the arena
+    unsigned int heap_allocs;     // allocations that fell back to malloc
+    size_t high_water;            // most arena bytes one message used
+} JsonArenaStats;
+
+// Route cJSON's allocations through the arena (cJSON_InitHooks). Called by
+// json_arena_parse on first use.
+void json_arena_install(void);
+
+// cJSON_ParseWithLength into the arena. Release the tree with
+// json_arena_release before parsing the next message.
+cJSON* json_arena_parse(const char* json, size_t len);
+
+// Drop a tree from json_arena_parse (NULL is fine) and reset the arena
+void json_arena_release(cJSON* root);
+
+// Cumulative counters
+const JsonArenaStats* json_arena_get_stats(void);
+
+#endif // JSON_ARENA_H
@@ -0,0 +1,459 @@
+#include "json_codec.h"
+#include <stddef.h>
+#include <string.h>
+#include <limits.h>
+
+#define JSON_MAX_DEPTH 16   // nesting skip_value follows before giving up
+
+typedef enum {
+    KIND_NONE = 0,
+    KIND_TYPE,      // "type", mapped to MessageType
+    KIND_STATE,     // "state", mapped to AgentState
+    KIND_STRING,
+    KIND_INT,
+    KIND_BOOL,
+    KIND_ENTRIES,   // "messages" of a batch
+} KeyKind;
+
+typedef struct {
+    const char* name;
+    unsigned char len;
+    unsigned char kind;
+    unsigned char field;
+    unsigned char offset;   // of the value in WireMessage
+} JsonKey;
+
+// Perfect hash of the known keys: length, first and last character.
+// Every key below lands in its own bucket; a lookup is confirmed with a
+// memcmp, so anything else misses.
+#define KEY_HASH(len, first, last) \
+    (((unsigned)(len) * 10 + (unsigned char)(first) * 5 + (unsigned char)(last)) & 31)
+
+#define KEY(name, kind, field, member) \
+    { name, sizeof(name) - 1, kind, field, offsetof(WireMessage, member) }
+
+// Indexed by KEY_HASH of the name. Keep in sync with json_decode_tree.
+static const JsonKey keys[32] = {
+    [ 0] = KEY("pendingCommand", KIND_STRING, FIELD_PENDING_COMMAND, pending_command),
+    [ 1] = KEY("promptToolType", KIND_STRING, FIELD_PROMPT_TOOL_TYPE, prompt_tool_type),
+    [ 2] = KEY("serverMs", KIND_INT, FIELD_SERVER_MS, server_ms),
+    [ 4] = KEY("messages", KIND_ENTRIES, 0, type),
+    [ 5] = KEY("id", KIND_INT, FIELD_TRACE_ID, trace_id),
+    [ 6] = KEY("active", KIND_BOOL, FIELD_ACTIVE, active),
+    [ 8] = KEY("promptDescription", KIND_STRING, FIELD_PROMPT_DESCRIPTION, prompt_description),
+    [ 9] = KEY("autoEdit", KIND_BOOL, FIELD_AUTO_EDIT, auto_edit),
+    [11] = KEY("agent", KIND_STRING, FIELD_AGENT, agent),
+    [12] = KEY("message", KIND_STRING, FIELD_MESSAGE, message),
+    [14] = KEY("seq", KIND_INT, FIELD_SEQ, seq),
+    [15] = KEY("contextPercent", KIND_INT, FIELD_CONTEXT_PERCENT, context_percent),
+    [17] = KEY("type", KIND_TYPE, 0, type),
+    [18] = KEY("clientMs", KIND_INT, FIELD_CLIENT_MS, client_ms),
+    [19] = KEY("progress", KIND_INT, FIELD_PROGRESS, progress),
+    [22] = KEY("state", KIND_STATE, FIELD_STATE, state),
+    [24] = KEY("success", KIND_BOOL, FIELD_SUCCESS, success),
+    [27] = KEY("slot", KIND_INT, FIELD_SLOT, slot),
+    [28] = KEY("promptToolDetail", KIND_STRING, FIELD_PROMPT_TOOL_DETAIL, prompt_tool_detail),
+    [29] = KEY("error", KIND_STRING, FIELD_ERROR, error),
+};
+
+static const JsonKey* find_key(WireString name) {
+    if (name.len == 0) return NULL;
+    const JsonKey* key = &keys[KEY_HASH(name.len, name.str[0], name.str[name.len - 1])];
+    if (key->name && key->len == name.len && memcmp(key->name, name.str, name.len) == 0)
+        return key;
+    return NULL;
+}
+
+static bool wire_equals(WireString w, const char* s) {
+    return (size_t)w.len == strlen(s) && memcmp(w.str, s, w.len) == 0;
+}
+
+static MessageType type_from_wire(WireString w) {
+    if (wire_equals(w, "agent_status")) return MSG_AGENT_STATUS;
+    if (wire_equals(w, "agent_delta")) return MSG_AGENT_DELTA;
+    if (wire_equals(w, "spawn_result")) return MSG_SPAWN_RESULT;
+    if (wire_equals(w, "batch")) return MSG_SLOT_BATCH;
+    if (wire_equals(w, "action_ack")) return MSG_ACTION_ACK;
+    return MSG_UNKNOWN;
+}
+
+static AgentState state_from_wire(WireString w) {
+    if (wire_equals(w, "working")) return STATE_WORKING;
+    if (wire_equals(w, "waiting")) return STATE_WAITING;
+    if (wire_equals(w, "error")) return STATE_ERROR;
+    if (wire_equals(w, "done")) return STATE_DONE;
+    return STATE_IDLE;
+}
+
+typedef struct {
+    const char* p;
+    const char* end;
+    char* scratch;
+    int scratch_left;
+} JsonReader;
+
+static void skip_ws(JsonReader* r) {
+    while (r->p < r->end && (*r->p == ' ' || *r->p == '\t' || *r->p == '\n' || *r->p == '\r'))
+        r->p++;
+}
+
+// Consume c after optional whitespace
+static bool expect(JsonReader* r, char c) {
+    skip_ws(r);
+    if (r->p >= r->end || *r->p != c) return false;
+    r->p++;
+    return true;
+}
+
+static bool peek(JsonReader* r, char c) {
+    skip_ws(r);
+    return r->p < r->end && *r->p == c;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool read_hex4(JsonReader* r, unsigned int* out) {
+    if (r->end - r->p < 4) return false;
+    unsigned int value = 0;
+    for (int i = 0; i < 4; i++) {
+        int h = hex_value(r->p[i]);
+        if (h < 0) return false;
+        value = (value << 4) | (unsigned int)h;
+    }
+    r->p += 4;
+    *out = value;
+    return true;
+}
+
+static bool put_byte(JsonReader* r, char** out, unsigned int b) {
+    if (r->scratch_left == 0) return false;
+    *(*out)++ = (char)b;
+    r->scratch_left--;
+    return true;
+}
+
+// \uXXXX (and a following low surrogate) as UTF-8
+static bool put_unicode(JsonReader* r, char** out) {
+    unsigned int cp;
+    if (!read_hex4(r, &cp)) return false;
+    if (cp >= 0xDC00 && cp <= 0xDFFF) return false;
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+        unsigned int low;
+        if (r->end - r->p < 2 || r->p[0] != '\\' || r->p[1] != 'u') return false;
+        r->p += 2;
+        if (!read_hex4(r, &low) || low < 0xDC00 || low > 0xDFFF) return false;
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+    }
+
+    if (cp < 0x80) return put_byte(r, out, cp);
+    if (cp < 0x800) {
+        return put_byte(r, out, 0xC0 | (cp >> 6)) &&
+               put_byte(r, out, 0x80 | (cp & 0x3F));
+    }
+    if (cp < 0x10000) {
+        return put_byte(r, out, 0xE0 | (cp >> 12)) &&
+               put_byte(r, out, 0x80 | ((cp >> 6) & 0x3F)) &&
+               put_byte(r, out, 0x80 | (cp & 0x3F));
+    }
+    return put_byte(r, out, 0xF0 | (cp >> 18)) &&
+           put_byte(r, out, 0x80 | ((cp >> 12) & 0x3F)) &&
+           put_byte(r, out, 0x80 | ((cp >> 6) & 0x3F)) &&
+           put_byte(r, out, 0x80 | (cp & 0x3F));
+}
+
+// Read a string starting at its opening quote. Without escapes it stays in
+// the payload; otherwise it is unescaped into scratch.
+static bool read_string(JsonReader* r, WireString* out) {
+    if (!expect(r, '"')) return false;
+    const char* start = r->p;
+    const char* quote = memchr(start, '"', r->end - start);
+    if (quote == NULL) return false;
+    const char* escape = memchr(start, '\\', quote - start);
+    if (escape == NULL) {
+        out->str = start;
+        out->len = (int)(quote - start);
+        r->p = quote + 1;
+        return true;
+    }
+    r->p = escape;
+
+    // Escaped: copy what was scanned so far, then decode the rest
+    int prefix = (int)(r->p - start);
+    if (prefix > r->scratch_left) return false;
+    char* dst = r->scratch;
+    memcpy(dst, start, prefix);
+    char* w = dst + prefix;
+    r->scratch_left -= prefix;
+
+    while (r->p < r->end && *r->p != '"') {
+        char c = *r->p++;
+        if (c == '\\') {
+            if (r->p >= r->end) return false;
+            char e = *r->p++;
+            switch (e) {
+                case '"': case '\\': case '/': c = e; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'u':
+                    if (!put_unicode(r, &w)) return false;
+                    continue;
+                default: return false;
+            }
+        }
+        if (!put_byte(r, &w, (unsigned char)c)) return false;
+    }
+    if (r->p >= r->end) return false;
+    r->p++;
+
+    out->str = dst;
+    out->len = (int)(w - dst);
+    r->scratch = w;
+    return true;
+}
+
+// Integer part of a number, saturated to int like cJSON's valueint.
+// A fraction is dropped; exponents are left to cJSON.
+static bool read_int(JsonReader* r, int* out) {
+    skip_ws(r);
+    bool negative = r->p < r->end && *r->p == '-';
+    if (negative) r->p++;
+    if (r->p >= r->end || *r->p < '0' || *r->p > '9') return false;
+
+    long long value = 0;
+    while (r->p < r->end && *r->p >= '0' && *r->p <= '9') {
+        if (value <= INT_MAX) value = value * 10 + (*r->p - '0');
+        r->p++;
+    }
+    if (r->p < r->end && *r->p == '.') {
+        r->p++;
+        if (r->p >= r->end || *r->p < '0' || *r->p > '9') return false;
+        while (r->p < r->end && *r->p >= '0' && *r->p <= '9') r->p++;
+    }
+    if (r->p < r->end && (*r->p == 'e' || *r->p == 'E')) return false;
+
+    if (negative) value = -value;
+    if (value > INT_MAX) value = INT_MAX;
+    if (value < INT_MIN) value = INT_MIN;
+    *out = (int)value;
+    return true;
+}
+
+static bool read_literal(JsonReader* r, const char* word) {
+    size_t n = strlen(word);
+    if ((size_t)(r->end - r->p) < n || memcmp(r->p, word, n) != 0) return false;
+    r->p += n;
+    return true;
+}
+
+static bool read_bool(JsonReader* r, bool* out) {
+    skip_ws(r);
+    if (read_literal(r, "true")) *out = true;
+    else if (read_literal(r, "false")) *out = false;
+    else return false;
+    return true;
+}
+
+// Step over any value, checking its syntax
+static bool skip_value(JsonReader* r, int depth) {
+    if (depth > JSON_MAX_DEPTH) return false;
+    skip_ws(r);
+    if (r->p >= r->end) return false;
+
+    switch (*r->p) {
+        case '"': {
+            // Only the extent matters: the first quote not escaped by an
+            // odd run of backslashes
+            const char* p = r->p + 1;
+            for (;;) {
+                const char* quote = memchr(p, '"', r->end - p);
+                if (quote == NULL) return false;
+                const char* b = quote;
+                while (b > p && b[-1] == '\\') b--;
+                p = quote + 1;
+                if ((quote - b) % 2 == 0) break;
+            }
+            r->p = p;
+            return true;
+        }
+        case '{':
+            r->p++;
+            if (expect(r, '}')) return true;
+            do {
+                if (!peek(r, '"') || !skip_value(r, depth + 1)) return false;
+                if (!expect(r, ':') || !skip_value(r, depth + 1)) return false;
+            } while (expect(r, ','));
+            return expect(r, '}');
+        case '[':
+            r->p++;
+            if (expect(r, ']')) return true;
+            do {
+                if (!skip_value(r, depth + 1)) return false;
+            } while (expect(r, ','));
+            return expect(r, ']');
+        case 't': return read_literal(r, "true");
+        case 'f': return read_literal(r, "false");
+        case 'n': return read_literal(r, "null");
+        default: {
+            int ignored;
+            return read_int(r, &ignored);
+        }
+    }
+}
+
+// Read the value of a known key into msg. A value of another JSON type is
+// skipped, as the cJSON path ignores it.
+static bool read_value(JsonReader* r, const JsonKey* key, WireMessage* msg, WireString* entries) {
+    char* base = (char*)msg + key->offset;
+    WireString s;
+    skip_ws(r);
+
+    switch (key->kind) {
+        case KIND_TYPE:
+        case KIND_STATE:
+        case KIND_STRING:
+            if (!peek(r, '"')) break;
+            if (!read_string(r, &s)) return false;
+            if (key->kind == KIND_TYPE) {
+                msg->type = type_from_wire(s);
+                return true;
+            }
+            if (key->kind == KIND_STATE) msg->state = state_from_wire(s);
+            else *(WireString*)base = s;
+            msg->present |= FIELD_BIT(key->field);
+            return true;
+        case KIND_INT:
+            if (r->p >= r->end || (*r->p != '-' && (*r->p < '0' || *r->p > '9'))) break;
+            if (!read_int(r, (int*)base)) return false;
+            msg->present |= FIELD_BIT(key->field);
+            return true;
+        case KIND_BOOL:
+            if (!peek(r, 't') && !peek(r, 'f')) break;
+            if (!read_bool(r, (bool*)base)) return false;
+            msg->present |= FIELD_BIT(key->field);
+            return true;
+        case KIND_ENTRIES: {
+            if (!entries || !peek(r, '[')) break;
+            const char* start = r->p;
+            if (!skip_value(r, 1)) return false;
+            entries->str = start;
+            entries->len = (int)(r->p - start);
+            return true;
+        }
+    }
+    return skip_value(r, 1);
+}
+
+static bool decode_object(JsonReader* r, WireMessage* msg, WireString* entries) {
+    memset(msg, 0, sizeof(*msg));
+    if (entries) {
+        entries->str = NULL;
+        entries->len = 0;
+    }
+
+    if (!expect(r, '{')) return false;
+    if (expect(r, '}')) return true;
+    do {
+        // Key names are matched in place; the known ones have no escapes
+        char* scratch = r->scratch;
+        int left = r->scratch_left;
+        WireString name;
+        if (!read_string(r, &name) || !expect(r, ':')) return false;
+        const JsonKey* key = find_key(name);
+        r->scratch = scratch;
+        r->scratch_left = left;
+
+        if (key ? !read_value(r, key, msg, entries) : !skip_value(r, 1)) return false;
+    } while (expect(r, ','));
+    return expect(r, '}');
+}
+
+bool json_decode(const char* json, int len, WireMessage* msg, WireString* entries,
+                 char* scratch, int scratch_cap) {
+    JsonReader r = { json, json + len, scratch, scratch_cap };
+    return decode_object(&r, msg, entries);
+}
+
+bool json_batch_next(WireString entries, int* pos, WireMessage* msg,
+                     char* scratch, int scratch_cap) {
+    if (entries.len == 0) return false;
+    JsonReader r = { entries.str + *pos, entries.str + entries.len, scratch, scratch_cap };
+
+    // entries was checked by skip_value, so only '[', ',' or ']' can follow
+    if (!expect(&r, *pos == 0 ? '[' : ',')) {
+        if (expect(&r, ']')) *pos = entries.len;
+        return false;
+    }
+    if (*pos == 0 && expect(&r, ']')) {
+        *pos = entries.len;
+        return false;
+    }
+    if (!decode_object(&r, msg, NULL)) return false;
+    *pos = (int)(r.p - entries.str);
+    return true;
+}
+
+static void tree_string(const cJSON* root, const char* key, WireField field,
+                        WireString* out, WireMessage* msg) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(root, key);
+    if (item && cJSON_IsString(item)) {
+        out->str = item->valuestring;
+        out->len = (int)strlen(item->valuestring);
+        msg->present |= FIELD_BIT(field);
+    }
+}
+
+static void tree_int(const cJSON* root, const char* key, WireField field,
+                     int* out, WireMessage* msg) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(root, key);
+    if (item && cJSON_IsNumber(item)) {
+        *out = item->valueint;
+        msg->present |= FIELD_BIT(field);
+    }
+}
+
+static void tree_bool(const cJSON* root, const char* key, WireField field,
+                      bool* out, WireMessage* msg) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(root, key);
+    if (item && cJSON_IsBool(item)) {
+        *out = cJSON_IsTrue(item);
+        msg->present |= FIELD_BIT(field);
+    }
+}
+
+bool json_decode_tree(const cJSON* root, WireMessage* msg) {
+    const cJSON* type = cJSON_GetObjectItemCaseSensitive(root, "type");
+    if (type == NULL || !cJSON_IsString(type)) return false;
+
+    memset(msg, 0, sizeof(*msg));
+    msg->type = type_from_wire((WireString){ type->valuestring, (int)strlen(type->valuestring) });
+
+    tree_string(root, "agent", FIELD_AGENT, &msg->agent, msg);
+    WireString state = { NULL, 0 };
+    tree_string(root, "state", FIELD_STATE, &state, msg);
+    if (msg->present & FIELD_BIT(FIELD_STATE)) msg->state = state_from_wire(state);
+    tree_int(root, "progress", FIELD_PROGRESS, &msg->progress, msg);
+    tree_string(root, "message", FIELD_MESSAGE, &msg->message, msg);
+    tree_string(root, "pendingCommand", FIELD_PENDING_COMMAND, &msg->pending_command, msg);
+    tree_int(root, "contextPercent", FIELD_CONTEXT_PERCENT, &msg->context_percent, msg);
+    tree_string(root, "promptToolType", FIELD_PROMPT_TOOL_TYPE, &msg->prompt_tool_type, msg);
+    tree_string(root, "promptToolDetail", FIELD_PROMPT_TOOL_DETAIL, &msg->prompt_tool_detail, msg);
+    tree_string(root, "promptDescription", FIELD_PROMPT_DESCRIPTION, &msg->prompt_description, msg);
+    tree_int(root, "slot", FIELD_SLOT, &msg->slot, msg);
+    tree_bool(root, "active", FIELD_ACTIVE, &msg->active, msg);
+    tree_bool(root, "autoEdit", FIELD_AUTO_EDIT, &msg->auto_edit, msg);
+    tree_bool(root, "success", FIELD_SUCCESS, &msg->success, msg);
+    tree_string(root, "error", FIELD_ERROR, &msg->error, msg);
+    tree_int(root, "seq", FIELD_SEQ, &msg->seq, msg);
+    tree_int(root, "id", FIELD_TRACE_ID, &msg->trace_id, msg);
+    tree_int(root, "clientMs", FIELD_CLIENT_MS, &msg->client_ms, msg);
+    tree_int(root, "serverMs", FIELD_SERVER_MS, &msg->server_ms, msg);
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef JSON_CODEC_H
+#define JSON_CODEC_H
+
+#include "protocol.h"
+#include "cJSON.h"
+
+// Decoding of JSON server messages into a WireMessage without building a
+// tree. One pass over the payload: each key is matched against the known
+// key set with a perfect hash and its value is written straight into the
+// message; unknown keys are skipped. Nothing is allocated.
+//
+// Strings without escapes point into the payload. Escaped strings are
+// unescaped into a caller-provided scratch buffer; a message whose escaped
+// strings don't fit, or that uses number exponents or deep nesting, is
+// rejected so the caller can fall back to cJSON (json_decode_tree).
+
+#define JSON_SCRATCH_SIZE 4096
+
+// Decode one message. A missing or non-string "type" decodes as
+// MSG_UNKNOWN. If entries is not NULL it receives the "messages" array of a
+// batch (empty if there is none) for json_batch_next.
+// Returns false if the message is malformed or needs the cJSON path.
+bool json_decode(const char* json, int len, WireMessage* msg, WireString* entries,
+                 char* scratch, int scratch_cap);
+
+// Decode the next entry of a batch's "messages" array. Start with *pos = 0;
+// scratch is reused, so apply each entry before decoding the next.
+// Returns false at the end of the array, with *pos == entries.len, or on an
+// entry json_decode would reject, with *pos short of it.
+bool json_batch_next(WireString entries, int* pos, WireMessage* msg,
+                     char* scratch, int scratch_cap);
+
+// Fill msg from a parsed cJSON message object. Strings in msg point into
+// the tree, which must outlive msg. Returns false without a string "type".
+bool json_decode_tree(const cJSON* root, WireMessage* msg);
+
+#endif // JSON_CODEC_H
@@ -5,28 +5,51 @@
 #include <stdbool.h>
 #include "ui.h"
 #include "protocol.h"
+#include "agent.h"
 #include "network.h"
 #include "config.h"
 #include "animation.h"
 #include "creature.h"
 #include "audio.h"
 
-// Reconnection timing
-#define RECONNECT_INTERVAL 120  // frames (~2 seconds at 60fps)
-
 static Agent agents[MAX_AGENTS];
 static int agent_count = 0;
+static int party_size = DEFAULT_AGENT_SLOTS;   // slots offered by the server
 static int selectedAgent = 0;
-static int reconnect_timer = 0;
 static bool network_ready = false;       // network_init() succeeded
-static bool first_connection_done = false;  // defer first connect until after first frame (avoids blocking on real 3DS)
+static bool network_threaded = false;    // worker thread owns the connection
 static bool auto_edit = false;           // auto-accept Edit/Write tools
 static int scroll_cooldown = 0;          // frame counter for circle pad debounce
+#if SHOW_LATENCY
+static unsigned int shown_acks = 0;      // latency overlay is up to date with these
+#endif
 
-// Animation state per creature slot
-static AnimState creature_anims[MAX_AGENTS];
+// Animation state of all creature slots
+static AnimBank creature_anims;
 static AgentState prev_agent_states[MAX_AGENTS];  // for detecting state transitions
 
+// Change tracking. Anything that alters what is on screen bumps
+// view_generation; frames where it still matches drawn_generation skip
+// rendering and leave the last frame displayed.
+static u32 view_generation = 1;
+static u32 drawn_generation = 0;
+static NetworkPhase drawn_phase = NET_IDLE;
+static aptHookCookie apt_cookie;
+
+static void on_apt_event(APT_HookType hook, void* param) {
+    // Redraw after coming back from the HOME menu or sleep
+    if (hook == APTHOOK_ONRESTORE || hook == APTHOOK_ONWAKEUP)
+        view_generation++;
+}
+
+static const AnimDef* state_animation(AgentState state) {
+    switch (state) {
+        case STATE_WORKING: return &anim_working;
+        case STATE_WAITING: return &anim_waiting;
+        default:            return &anim_idle;
+    }
+}
+
 int main(int argc, char* argv[]) {
     // Initialize services
     gfxInitDefault();
@@ -42,30 +65,40 @@ int main(int argc, char* argv[]) {
 
     // Initialize UI and network
     ui_init();
+    aptHook(&apt_cookie, on_apt_event, NULL);
 
     network_ready = network_init();
     if (!network_ready)
         printf("Network init failed!\n");
-    /* First connection is done after first frame so we don't block gfx on real 3DS (DNS/connect can hang). */
 
     // Initialize audio
     audio_init();
 
     // Initialize default agent
-    strcpy(agents[0].name, "CLAUDE");
-    agents[0].state = STATE_IDLE;
-    agents[0].progress = -1;
-    strcpy(agents[0].message, "Connecting...");
-    agents[0].slot = 0;
+    agent_clear(&agents[0], 0);
+    AgentText* text = agent_text_mut(&agents[0]);
+    if (text) {
+        agent_text_set(text, TEXT_NAME, "CLAUDE", 6);
+        agent_text_set(text, TEXT_MESSAGE, "Connecting...", 13);
+    }
     agents[0].active = true;
     agent_count = 1;
 
     // Initialize animation states
+    anim_bank_init(&creature_anims, MAX_AGENTS, &anim_idle);
     for (int i = 0; i < MAX_AGENTS; i++) {
-        anim_set(&creature_anims[i], &anim_idle);
         prev_agent_states[i] = STATE_IDLE;
     }
 
+    // Networking runs on its own thread when possible; otherwise connecting
+    // never blocks and network_poll advances it every frame
+    if (network_ready) {
+        printf("Connecting to %s:%d...\n", SERVER_HOST, SERVER_PORT);
+        network_threaded = network_start_thread(SERVER_HOST, SERVER_PORT);
+        if (!network_threaded)
+            network_connect(SERVER_HOST, SERVER_PORT);
+    }
+
     // Main loop
     while (aptMainLoop()) {
         hidScanInput();
@@ -74,51 +107,73 @@ int main(int argc, char* argv[]) {
         if (kDown & KEY_START)
             break;
 
+        int prev_selected = selectedAgent;
+
         // Network polling
-        network_poll(agents, &agent_count);
-
-        // Reconnection logic
-        if (!network_is_connected()) {
-            reconnect_timer++;
-            if (reconnect_timer >= RECONNECT_INTERVAL) {
-                reconnect_timer = 0;
-                printf("Reconnecting...\n");
-                network_connect(SERVER_HOST, SERVER_PORT);
-            }
-        } else {
-            reconnect_timer = 0;
+        unsigned int changed_slots = network_poll(agents, &agent_count);
+        if (changed_slots)
+            view_generation++;
+        if (selectedAgent >= agent_count && agent_count > 0)
+            selectedAgent = agent_count - 1;
+
+        // Reconnection (the worker thread reconnects on its own).
+        // network_reconnect_due paces the attempts: at once after a drop
+        // or when WiFi comes back, with backoff while the server is down.
+        if (network_ready && !network_threaded && network_reconnect_due()) {
+            printf("Reconnecting...\n");
+            network_connect(SERVER_HOST, SERVER_PORT);
         }
 
-        // Tick animations and detect state transitions
-        for (int i = 0; i < agent_count; i++) {
-            // Map agent state to animation
-            const AnimDef* target_anim = &anim_idle;
-            switch (agents[i].state) {
-                case STATE_WORKING: target_anim = &anim_working; break;
-                case STATE_WAITING: target_anim = &anim_waiting; break;
-                default: target_anim = &anim_idle; break;
-            }
+        // Pick animations for slots whose agent changed and detect state
+        // transitions
+        for (int i = 0; i < agent_count && changed_slots; i++) {
+            if (!(changed_slots & BIT(i))) continue;
 
-            // Switch animation if state changed (but not during spawn)
-            if (!agents[i].spawning && creature_anims[i].current != target_anim) {
-                anim_set(&creature_anims[i], target_anim);
+            // A successful spawn plays the pokeball sequence once; the
+            // state animation below is queued behind it
+            if (agents[i].spawning) {
+                agents[i].spawning = false;
+                anim_bank_play(&creature_anims, i, &anim_spawn);
             }
+            anim_bank_set(&creature_anims, i, state_animation(agents[i].state));
 
             // Audio beep on transition to WAITING
             if (agents[i].state == STATE_WAITING && prev_agent_states[i] != STATE_WAITING) {
                 audio_play_prompt_beep();
             }
             prev_agent_states[i] = agents[i].state;
+        }
+
+        // Advance every slot's animation in one pass; only keyframe changes
+        // of creatures on screen call for a redraw
+        if (anim_bank_tick(&creature_anims, osGetTime()) & ui_visible_slots())
+            view_generation++;
 
-            anim_tick(&creature_anims[i]);
+        // The party grows or shrinks to what the server offered at connect
+        if (network_get_slot_count() != party_size) {
+            party_size = network_get_slot_count();
+            ui_set_party_size(party_size);
+            view_generation++;
         }
 
         // Sync auto-edit state from server broadcasts
         if (network_get_auto_edit() != auto_edit) {
             auto_edit = network_get_auto_edit();
             ui_set_auto_edit(auto_edit);
+            view_generation++;
         }
 
+#if SHOW_LATENCY
+        // The latency overlay follows the action acks as they arrive
+        NetworkLatency latency;
+        network_get_latency(&latency);
+        if (latency.acks != shown_acks) {
+            shown_acks = latency.acks;
+            ui_set_latency(latency.last_ms, latency.p95_ms);
+            view_generation++;
+        }
+#endif
+
         // Handle touch
         if (kDown & KEY_TOUCH) {
             touchPosition touch;
@@ -126,31 +181,34 @@ int main(int argc, char* argv[]) {
 
             // Check creature slot taps first
             int tapped_slot = ui_touch_creature_slot(touch);
-            if (tapped_slot >= 0 && tapped_slot < agent_count) {
+            if (ui_touch_party_page(touch)) {
+                view_generation++;
+            } else if (tapped_slot >= 0 && agents[tapped_slot].active) {
                 selectedAgent = tapped_slot;
                 printf("Selected agent slot %d\n", tapped_slot);
-            } else if (tapped_slot >= 0 && tapped_slot >= agent_count) {
+            } else if (tapped_slot >= 0) {
                 // Tapped empty slot — request spawn
                 printf("Spawn requested for slot %d\n", tapped_slot);
-                network_send_command(agents[0].name, "spawn");
+                network_send_command(agent_text(&agents[0])->name, "spawn");
             } else if (ui_touch_spawn(touch)) {
                 printf("Spawn button tapped\n");
-                network_send_command(agents[0].name, "spawn");
+                network_send_command(agent_text(&agents[0])->name, "spawn");
             } else if (ui_touch_auto_edit(touch)) {
                 auto_edit = !auto_edit;
                 ui_set_auto_edit(auto_edit);
-                network_send_config(agents[selectedAgent].name, auto_edit);
+                view_generation++;
+                network_send_config(agent_text(&agents[selectedAgent])->name, auto_edit);
                 printf("Auto-edit: %s\n", auto_edit ? "ON" : "OFF");
             } else if (agents[selectedAgent].state == STATE_WAITING) {
                 if (ui_touch_yes(touch)) {
                     printf("Sending yes\n");
-                    network_send_action(agents[selectedAgent].name, "yes");
+                    network_send_action(agent_text(&agents[selectedAgent])->name, "yes");
                 } else if (ui_touch_always(touch)) {
                     printf("Sending always\n");
-                    network_send_action(agents[selectedAgent].name, "always");
+                    network_send_action(agent_text(&agents[selectedAgent])->name, "always");
                 } else if (ui_touch_no(touch)) {
                     printf("Sending no\n");
-                    network_send_action(agents[selectedAgent].name, "no");
+                    network_send_action(agent_text(&agents[selectedAgent])->name, "no");
                 }
             }
         }
@@ -159,15 +217,15 @@ int main(int argc, char* argv[]) {
         if (agents[selectedAgent].state == STATE_WAITING) {
             if (kDown & KEY_A) {
                 printf("Button A: yes\n");
-                network_send_action(agents[selectedAgent].name, "yes");
+                network_send_action(agent_text(&agents[selectedAgent])->name, "yes");
             }
             if (kDown & KEY_B) {
                 printf("Button B: no\n");
-                network_send_action(agents[selectedAgent].name, "no");
+                network_send_action(agent_text(&agents[selectedAgent])->name, "no");
             }
             if (kDown & KEY_X) {
                 printf("Button X: always\n");
-                network_send_action(agents[selectedAgent].name, "always");
+                network_send_action(agent_text(&agents[selectedAgent])->name, "always");
             }
         }
 
@@ -175,7 +233,8 @@ int main(int argc, char* argv[]) {
         if (kDown & KEY_Y) {
             auto_edit = !auto_edit;
             ui_set_auto_edit(auto_edit);
-            network_send_config(agents[selectedAgent].name, auto_edit);
+            view_generation++;
+            network_send_config(agent_text(&agents[selectedAgent])->name, auto_edit);
             printf("Button Y: auto-edit %s\n", auto_edit ? "ON" : "OFF");
         }
 
@@ -185,20 +244,22 @@ int main(int argc, char* argv[]) {
         hidCircleRead(&cpad);
         if (scroll_cooldown == 0) {
             if (cpad.dy > 40) {
-                ui_scroll_detail(-1);  // stick up = scroll up
+                if (ui_scroll_detail(-1))  // stick up = scroll up
+                    view_generation++;
                 scroll_cooldown = 8;   // ~8 frames between scrolls
             } else if (cpad.dy < -40) {
-                ui_scroll_detail(1);   // stick down = scroll down
+                if (ui_scroll_detail(1))   // stick down = scroll down
+                    view_generation++;
                 scroll_cooldown = 8;
             }
         }
 
         // D-pad left/right for precise single-line scrolling
-        if (kDown & KEY_LEFT) {
-            ui_scroll_detail(-1);
+        if ((kDown & KEY_LEFT) && ui_scroll_detail(-1)) {
+            view_generation++;
         }
-        if (kDown & KEY_RIGHT) {
-            ui_scroll_detail(1);
+        if ((kDown & KEY_RIGHT) && ui_scroll_detail(1)) {
+            view_generation++;
         }
 
         // D-pad up/down to switch agents
@@ -217,25 +278,33 @@ int main(int argc, char* argv[]) {
             selectedAgent = (selectedAgent - 1 + agent_count) % agent_count;
         }
 
-        // Render (always draw first so real 3DS shows UI before any blocking connect)
-        C3D_FrameBegin(C3D_FRAME_SYNCDRAW);
-        ui_render_top(topScreen, agents, agent_count, selectedAgent,
-                      network_is_connected(), creature_anims);
-        ui_render_bottom(bottomScreen, agents, agent_count, selectedAgent,
-                         network_is_connected(), creature_anims);
-        C3D_FrameEnd(0);
+        NetworkPhase phase = network_get_phase();
+        if (selectedAgent != prev_selected || phase != drawn_phase)
+            view_generation++;
 
-        // Deferred first connection: after first frame so hardware doesn't block before any draw
-        if (network_ready && !first_connection_done) {
-            first_connection_done = true;
-            printf("Connecting to %s:%d...\n", SERVER_HOST, SERVER_PORT);
-            network_connect(SERVER_HOST, SERVER_PORT);
+        // Render only when something changed; otherwise the last frame stays
+        // on screen and the GPU idles until the next vblank
+        if (view_generation != drawn_generation) {
+            drawn_generation = view_generation;
+            drawn_phase = phase;
+            C3D_FrameBegin(C3D_FRAME_SYNCDRAW);
+            ui_render_top(topScreen, agents, agent_count, selectedAgent,
+                          phase == NET_CONNECTED, &creature_anims);
+            ui_render_bottom(bottomScreen, agents, agent_count, selectedAgent,
+                             phase, &creature_anims);
+            C3D_FrameEnd(0);
+        } else {
+            gspWaitForVBlank();
         }
     }
 
     // Cleanup
+    aptUnhook(&apt_cookie);
     audio_exit();
     network_exit();
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        agent_free(&agents[i]);
+    }
     ui_exit();
     C2D_Fini();
     C3D_Fini();
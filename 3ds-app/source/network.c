@@ -1,5 +1,12 @@
 #include "network.h"
+#include "agent.h"
+#include "codec.h"
+#include "config.h"
+#include "spsc.h"
 #include "cJSON.h"
+#include "json_arena.h"
+#include "json_codec.h"
+#include "ws_writer.h"
 #include <3ds.h>
 #include <string.h>
 #include <stdio.h>
@@ -9,19 +16,149 @@
 #include <errno.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <netdb.h>
+#include <poll.h>
 #include <unistd.h>
 
 #define RECV_BUF_SIZE 4096
-#define SEND_BUF_SIZE 1024
+#define SEND_BUF_SIZE 1024             // largest outgoing frame
+#define OUT_BUF_SIZE  (4 * SEND_BUF_SIZE)  // written bytes the socket hasn't taken yet
+#define MAX_MESSAGE_SIZE (64 * 1024)  // largest reassembled message we accept
+#define CONNECT_TIMEOUT_MS 10000       // TCP connect + WebSocket upgrade
+#define HEARTBEAT_INTERVAL_MS 1000     // ping the server this often while connected
+#define HEARTBEAT_TIMEOUT_MS  3000     // drop a connection silent for this long
+#define RESOLVER_STACK_SIZE 0x4000
+#define WORKER_STACK_SIZE   0x8000
+#define RECONNECT_MIN_MS    250        // wait after the first failed attempt
+#define RECONNECT_MAX_MS    30000      // backoff cap while the server is down
+#define WIFI_POLL_MS        250        // ACU_GetWifiStatus at most this often
+#define WORKER_WAIT_MS      2          // idle wait between worker iterations
+#define UPDATE_QUEUE_SIZE   16         // slot snapshots, worker -> main
+#define SEND_QUEUE_SIZE     16         // outgoing messages, main -> worker
+
+// WebSocket opcodes (RFC 6455 section 5.2)
+#define WS_OP_CONTINUATION 0x0
+#define WS_OP_TEXT         0x1
+#define WS_OP_BINARY       0x2
+#define WS_OP_CLOSE        0x8
+#define WS_OP_PING         0x9
+#define WS_OP_PONG         0xA
+
+// WebSocket close status codes
+#define WS_CLOSE_NORMAL    1000
+#define WS_CLOSE_PROTOCOL  1002
+#define WS_CLOSE_TOO_BIG   1009
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
 
 static int sock = -1;
-static bool connected = false;
-static bool ws_handshake_done = false;
-static char recv_buf[RECV_BUF_SIZE];
-static int recv_buf_len = 0;
+static NetworkPhase phase = NET_IDLE;   // written by whichever thread runs the connection
+static u64 phase_started = 0;     // osGetTime() when the connect attempt began
+static char conn_host[64];
+static int conn_port = 0;
 static bool server_auto_edit = false;
+static NetworkStats stats;
+
+// Receive buffer. Unconsumed bytes live in [recv_head, recv_tail); frames are
+// parsed in place and consuming one just advances recv_head. The buffer is
+// rewound for free once drained and only compacted when the tail reaches the
+// end with a partial frame still pending. One spare byte keeps the data
+// NUL-terminated for the handshake scan.
+static char recv_buf[RECV_BUF_SIZE + 1];
+static int recv_head = 0;
+static int recv_tail = 0;
+
+// Outgoing bytes, [out_head, out_tail). Frames are appended whole and
+// flushed with one send() for everything pending; whatever a short write
+// or EAGAIN leaves behind is retried on the next poll. Only the thread
+// that runs the connection touches it.
+static unsigned char out_buf[OUT_BUF_SIZE];
+static int out_head = 0;
+static int out_tail = 0;
+
+// Reassembly of fragmented messages and frames too large for recv_buf.
+// msg_buf grows on demand (up to MAX_MESSAGE_SIZE) and is kept for reuse.
+static char* msg_buf = NULL;
+static int msg_cap = 0;
+static int msg_len = 0;
+static int msg_opcode = -1;       // opcode of the message in progress, -1 if none
+static int frame_remaining = 0;   // payload bytes of the current frame still to copy
+static bool frame_fin = false;    // current frame ends the message
+
+// Unescaped JSON strings of the message being decoded (see json_codec.h)
+static char json_scratch[JSON_SCRATCH_SIZE];
+
+static void reset_message(void) {
+    msg_len = 0;
+    msg_opcode = -1;
+    frame_remaining = 0;
+    frame_fin = false;
+}
+
+// The main thread reads the phase while a worker thread may be advancing it
+static void set_phase(NetworkPhase next) {
+    __atomic_store_n(&phase, next, __ATOMIC_RELAXED);
+}
+
+// Delta sync (agent_delta). A slot is synced once a full agent_status with a
+// seq has been applied; after that each delta must carry exactly seq + 1.
+static int slot_seq[MAX_AGENTS];
+static bool slot_synced[MAX_AGENTS];
+static bool resync_pending[MAX_AGENTS];
+
+// Server run the slot seqs belong to (X-Raids-Epoch), 0 if none. A
+// reconnect to the same run offers them as resume points.
+static int server_epoch = 0;
+
+// Party slots agreed with the server in the upgrade response. Messages for
+// slots beyond it are ignored.
+static int slot_count = DEFAULT_AGENT_SLOTS;
+
+// Slots changed by received messages and not yet published to the main
+// thread (worker mode only)
+static unsigned int dirty_slots = 0;
+
+// Action round trips (see NetworkLatency), recorded by the thread that
+// runs the connection. Each published field is written atomically so the
+// main thread can read them while the worker records.
+static int rtt_window[LATENCY_WINDOW];
+static NetworkLatency latency = { 0, -1, -1, -1, -1, -1 };
+
+// Heartbeat. Any bytes from the server count as a sign of life; the pongs
+// to our pings also time the link. The smoothed round trip is kept the way
+// TCP does (RFC 6298), scaled by 8 for precision in integer milliseconds.
+static u64 last_received = 0;     // osGetTime() of the last bytes from the server
+static u64 last_ping = 0;
+static int srtt8 = -1;            // smoothed round trip * 8, -1 before the first pong
+static int rttvar4 = 0;           // round-trip variation * 4
+static int link_rtt_ms = -1;      // srtt8 / 8, published for the main thread
+
+// Reconnect scheduling (see reconnect_due), on the thread that runs the
+// connection
+static u64 reconnect_at = 0;          // osGetTime() when the next attempt is due
+static int reconnect_failures = 0;    // failed attempts since the last connection
+static bool reconnect_pending = false;    // an attempt was started, outcome unknown
+static bool reconnect_was_connected = false;
+static u32 reconnect_rng = 0;
+
+// WiFi link as ACU_GetWifiStatus last reported it
+static bool ac_ready = false;
+static bool wifi_up = true;
+static bool wifi_returned = false;    // came back since reconnect_due last looked
+static u64 wifi_checked = 0;
+
+// Trace ids of outgoing actions (main thread)
+static int next_trace_id = 1;
+
+// Milliseconds on the client clock carried by actions and echoed in acks,
+// kept positive so it survives every integer encoding
+static int trace_clock_ms(void) {
+    return (int)(osGetTime() & 0x7FFFFFFF);
+}
 
 // Simple WebSocket key (fixed for simplicity)
 static const char* WS_KEY = "dGhlIHNhbXBsZSBub25jZQ==";
@@ -40,280 +177,967 @@ bool network_init(void) {
             return false;
         }
     }
+    // WiFi status for the reconnect scheduler; without it the link is
+    // assumed up
+    if (!ac_ready) ac_ready = R_SUCCEEDED(acInit());
     return true;
 }
 
+// Host name lookups run on a worker thread so a slow DNS server never stalls
+// a frame. The last successful lookup is cached and reused on reconnect.
+static Thread resolver_thread = NULL;
+static bool resolver_done = false;        // set by the worker, read with acquire
+static char resolver_host[64];            // owned by the worker while it runs
+static bool resolver_ok = false;
+static struct in_addr resolver_addr;
+
+static char cached_host[64];
+static struct in_addr cached_addr;
+static bool cached_valid = false;
+
+static void resolver_main(void* arg) {
+    (void)arg;
+    struct hostent* server = gethostbyname(resolver_host);
+    resolver_ok = server != NULL && server->h_length == (int)sizeof(resolver_addr);
+    if (resolver_ok) {
+        memcpy(&resolver_addr, server->h_addr, sizeof(resolver_addr));
+    }
+    __atomic_store_n(&resolver_done, true, __ATOMIC_RELEASE);
+}
+
+static bool start_resolver(const char* host) {
+    snprintf(resolver_host, sizeof(resolver_host), "%s", host);
+    resolver_done = false;
+
+    s32 prio = 0x30;
+    svcGetThreadPriority(&prio, CUR_THREAD_HANDLE);
+    resolver_thread = threadCreate(resolver_main, NULL, RESOLVER_STACK_SIZE, prio + 1, -2, false);
+    return resolver_thread != NULL;
+}
+
+// Collect a finished lookup into the cache. Returns false while it is running.
+static bool reap_resolver(void) {
+    if (resolver_thread == NULL) return true;
+    if (!__atomic_load_n(&resolver_done, __ATOMIC_ACQUIRE)) return false;
+
+    threadJoin(resolver_thread, U64_MAX);
+    threadFree(resolver_thread);
+    resolver_thread = NULL;
+
+    if (resolver_ok) {
+        snprintf(cached_host, sizeof(cached_host), "%s", resolver_host);
+        cached_addr = resolver_addr;
+        cached_valid = true;
+    } else {
+        printf("Failed to resolve host: %s\n", resolver_host);
+    }
+    return true;
+}
+
+// Numeric addresses and cached lookups resolve without blocking
+static bool lookup_address(const char* host, struct in_addr* addr) {
+    if (inet_aton(host, addr)) return true;
+    if (cached_valid && strcmp(cached_host, host) == 0) {
+        *addr = cached_addr;
+        return true;
+    }
+    return false;
+}
+
 void network_exit(void) {
+    network_stop_thread();
     network_disconnect();
+    if (resolver_thread != NULL) {
+        threadJoin(resolver_thread, U64_MAX);
+        threadFree(resolver_thread);
+        resolver_thread = NULL;
+    }
+    if (ac_ready) {
+        acExit();
+        ac_ready = false;
+    }
     socExit();
 }
 
-bool network_connect(const char* host, int port) {
+// Abandon the current connect attempt; reconnect_due schedules the next
+static void fail_connection(const char* why) {
+    printf("Connect to %s:%d failed: %s\n", conn_host, conn_port, why);
     if (sock >= 0) {
-        network_disconnect();
+        close(sock);
+        sock = -1;
+    }
+    // The server may have moved (DHCP); look the name up again when the
+    // cached address fails twice in a row. A failure while WiFi is down
+    // says nothing about the address.
+    if (wifi_up && reconnect_failures > 0 && strcmp(cached_host, conn_host) == 0) {
+        cached_valid = false;
     }
+    set_phase(NET_IDLE);
+}
 
-    struct hostent* server = gethostbyname(host);
-    if (server == NULL) {
-        printf("Failed to resolve host: %s\n", host);
-        return false;
+// Integer value of a header ("\r\nName:") of the upgrade response in
+// [start, end), or fallback if it is missing
+static int parse_header_int(const char* start, const char* end, const char* header, int fallback) {
+    int header_len = (int)strlen(header);
+    for (const char* p = start; p < end; p++) {
+        if (*p == '\r' && strncasecmp(p, header, header_len) == 0) {
+            return atoi(p + header_len);
+        }
     }
+    return fallback;
+}
 
-    sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) {
-        printf("Failed to create socket\n");
-        return false;
+// Slot count from the X-Raids-Slots header. The server answers with at
+// most the slots= we asked for.
+static int parse_slot_count(const char* start, const char* end) {
+    int count = parse_header_int(start, end, "\r\nX-Raids-Slots:", DEFAULT_AGENT_SLOTS);
+    if (count < 1) return DEFAULT_AGENT_SLOTS;
+    return count < MAX_AGENTS ? count : MAX_AGENTS;
+}
+
+// The server run from X-Raids-Epoch. Slots synced with an earlier run are
+// all resent, so they start over; the rest were kept by a resume.
+static void accept_server_epoch(const char* start, const char* end) {
+    int epoch = parse_header_int(start, end, "\r\nX-Raids-Epoch:", 0);
+    if (epoch == 0 || epoch != server_epoch) {
+        memset(slot_synced, 0, sizeof(slot_synced));
+    } else {
+        for (int i = 0; i < MAX_AGENTS; i++) {
+            if (slot_synced[i]) stats.resumed_slots++;
+        }
     }
+    server_epoch = epoch;
+}
 
-    struct sockaddr_in serv_addr;
-    memset(&serv_addr, 0, sizeof(serv_addr));
-    serv_addr.sin_family = AF_INET;
-    memcpy(&serv_addr.sin_addr.s_addr, server->h_addr, server->h_length);
-    serv_addr.sin_port = htons(port);
+// Append bytes to out_buf. Returns false if they don't fit even after
+// moving what is pending to the front; a frame is never split.
+static bool queue_out(const void* data, int len) {
+    if (out_tail + len > OUT_BUF_SIZE && out_head > 0) {
+        memmove(out_buf, out_buf + out_head, out_tail - out_head);
+        out_tail -= out_head;
+        out_head = 0;
+    }
+    if (out_tail + len > OUT_BUF_SIZE) return false;
+    memcpy(out_buf + out_tail, data, len);
+    out_tail += len;
+    return true;
+}
 
-    if (connect(sock, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
-        printf("Failed to connect\n");
-        close(sock);
-        sock = -1;
-        return false;
+// Write as much of out_buf as the socket takes.
+// Returns false on a socket error (the connection is gone).
+static bool flush_out(void) {
+    while (out_head < out_tail) {
+        int pending = out_tail - out_head;
+        int n = send(sock, out_buf + out_head, pending, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                stats.send_retries++;
+                return true;
+            }
+            return false;
+        }
+        out_head += n;
+        stats.bytes_sent += n;
+        if (n < pending) stats.send_retries++;
     }
+    out_head = 0;
+    out_tail = 0;
+    return true;
+}
 
-    // Set non-blocking
-    int flags = fcntl(sock, F_GETFL, 0);
-    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+static void send_handshake(void) {
+    // Resuming: the seq each slot was last synced at, so the server sends
+    // only the slots that changed while we were away (-1: send it)
+    char resume[32 + MAX_AGENTS * 12] = "";
+    if (server_epoch != 0) {
+        int n = snprintf(resume, sizeof(resume), "&epoch=%d&since=", server_epoch);
+        for (int i = 0; i < slot_count; i++) {
+            n += snprintf(resume + n, sizeof(resume) - n, i > 0 ? ",%d" : "%d",
+                          slot_synced[i] ? slot_seq[i] : -1);
+        }
+    }
 
-    // Send WebSocket handshake
-    char handshake[512];
+    char handshake[768];
     snprintf(handshake, sizeof(handshake),
-        "GET / HTTP/1.1\r\n"
+        "GET /?features=delta,batch&slots=%d%s HTTP/1.1\r\n"
         "Host: %s:%d\r\n"
         "Upgrade: websocket\r\n"
         "Connection: Upgrade\r\n"
         "Sec-WebSocket-Key: %s\r\n"
         "Sec-WebSocket-Version: 13\r\n"
+#if PROTOCOL_BINARY
+        "Sec-WebSocket-Protocol: " WIRE_SUBPROTOCOL "\r\n"
+#endif
         "\r\n",
-        host, port, WS_KEY);
+        MAX_AGENTS, resume, conn_host, conn_port, WS_KEY);
 
-    send(sock, handshake, strlen(handshake), 0);
+    queue_out(handshake, (int)strlen(handshake));
+    set_phase(NET_HANDSHAKE);
+    flush_out();
+}
+
+// Open a non-blocking socket and start connecting to addr
+static void start_connect(struct in_addr addr) {
+    sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        fail_connection("socket");
+        return;
+    }
+
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+
+    // Actions are a few dozen bytes and shouldn't wait behind Nagle for the
+    // ACK of the previous one; coalescing happens in out_buf instead
+    int nodelay = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    struct sockaddr_in serv_addr;
+    memset(&serv_addr, 0, sizeof(serv_addr));
+    serv_addr.sin_family = AF_INET;
+    serv_addr.sin_addr = addr;
+    serv_addr.sin_port = htons(conn_port);
+
+    if (connect(sock, (struct sockaddr*)&serv_addr, sizeof(serv_addr)) == 0) {
+        send_handshake();
+    } else if (errno == EINPROGRESS || errno == EWOULDBLOCK) {
+        set_phase(NET_CONNECTING);
+    } else {
+        fail_connection(strerror(errno));
+    }
+}
+
+bool network_connect(const char* host, int port) {
+    if (sock >= 0) {
+        network_disconnect();
+    }
+
+    // Slot state from another server can't be resumed
+    if (strcmp(conn_host, host) != 0 || conn_port != port) {
+        server_epoch = 0;
+    }
+    snprintf(conn_host, sizeof(conn_host), "%s", host);
+    conn_port = port;
+    phase_started = osGetTime();
+    recv_head = 0;
+    recv_tail = 0;
+    recv_buf[0] = '\0';  // no stale upgrade response from a previous connection
+    out_head = 0;
+    out_tail = 0;
+    srtt8 = -1;          // a new route may time differently
+    reset_message();
+    if (server_epoch == 0) memset(slot_synced, 0, sizeof(slot_synced));
+    memset(resync_pending, 0, sizeof(resync_pending));
 
-    connected = true;
-    ws_handshake_done = false;
-    recv_buf_len = 0;
+    struct in_addr addr;
+    if (lookup_address(host, &addr)) {
+        start_connect(addr);
+        return phase != NET_IDLE;
+    }
 
+    // A lookup still running for an earlier attempt is picked up by
+    // advance_connect, which starts a new one if it was for another host
+    set_phase(NET_RESOLVING);
+    if (resolver_thread == NULL && !start_resolver(host)) {
+        fail_connection("resolver thread");
+        return false;
+    }
     return true;
 }
 
-void network_disconnect(void) {
+// Drive the connect state machine one step without blocking
+static void advance_connect(void) {
+    if (phase == NET_RESOLVING) {
+        if (!reap_resolver()) return;
+        struct in_addr addr;
+        if (lookup_address(conn_host, &addr)) {
+            start_connect(addr);
+        } else if (strcmp(resolver_host, conn_host) != 0) {
+            if (!start_resolver(conn_host)) fail_connection("resolver thread");
+        } else {
+            fail_connection("host not found");
+        }
+        return;
+    }
+
+    if (phase != NET_CONNECTING && phase != NET_HANDSHAKE) return;
+
+    if (osGetTime() - phase_started > CONNECT_TIMEOUT_MS) {
+        fail_connection("timed out");
+        return;
+    }
+
+    if (phase == NET_CONNECTING) {
+        struct pollfd pfd = { .fd = sock, .events = POLLOUT };
+        if (poll(&pfd, 1, 0) <= 0) return;
+
+        int err = 0;
+        socklen_t err_len = sizeof(err);
+        getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &err_len);
+        if (err != 0) {
+            fail_connection(strerror(err));
+            return;
+        }
+        send_handshake();
+    }
+}
+
+// Queue a frame behind whatever is still pending. It goes out with the
+// next flush_out.
+static void send_frame(const unsigned char* frame, int len) {
+    if (sock < 0 || phase != NET_CONNECTED) return;
+    if (!queue_out(frame, len)) {
+        stats.send_dropped++;
+        printf("Send buffer full, dropping frame\n");
+    }
+}
+
+// Control frames, sent by whichever thread runs the connection
+static void send_ws_frame_op(int opcode, const unsigned char* data, int len) {
+    unsigned char buf[WS_WRITER_HEADER + 125];
+    WsWriter w;
+    ws_writer_begin(&w, buf, sizeof(buf), opcode);
+    ws_writer_bytes(&w, data, len);
+
+    const unsigned char* frame;
+    int frame_len;
+    if (ws_writer_end(&w, &frame, &frame_len)) send_frame(frame, frame_len);
+}
+
+// Send a close frame with the given status code (if the WebSocket is up)
+// and drop the TCP connection
+static void close_connection(int code) {
     if (sock >= 0) {
+        unsigned char payload[2] = { (code >> 8) & 0xFF, code & 0xFF };
+        send_ws_frame_op(WS_OP_CLOSE, payload, sizeof(payload));
+        flush_out();  // best effort; the socket is closed either way
         close(sock);
         sock = -1;
     }
-    connected = false;
-    ws_handshake_done = false;
+    set_phase(NET_IDLE);
+    reset_message();
+    out_head = 0;
+    out_tail = 0;
+}
+
+void network_disconnect(void) {
+    close_connection(WS_CLOSE_NORMAL);
 }
 
 bool network_is_connected(void) {
-    return connected && ws_handshake_done;
+    return network_get_phase() == NET_CONNECTED;
+}
+
+NetworkPhase network_get_phase(void) {
+    return __atomic_load_n(&phase, __ATOMIC_RELAXED);
+}
+
+// ========== Reconnect scheduling ==========
+
+// Poll the WiFi link, at most every WIFI_POLL_MS (it is a service call)
+static void poll_wifi(u64 now) {
+    if (!ac_ready || now - wifi_checked < WIFI_POLL_MS) return;
+    wifi_checked = now;
+    u32 status = 0;
+    bool up = R_FAILED(ACU_GetWifiStatus(&status)) || status != 0;
+    if (up && !wifi_up) wifi_returned = true;
+    wifi_up = up;
 }
 
-static void parse_message(const char* json, Agent* agents, int* agent_count) {
-    cJSON* root = cJSON_Parse(json);
-    if (root == NULL) return;
+// Wait after the given number of failed attempts: doubling from
+// RECONNECT_MIN_MS up to RECONNECT_MAX_MS, drawn from the upper half of
+// that so clients that lost the server together don't retry in lockstep
+static int backoff_ms(int failures) {
+    int limit = RECONNECT_MAX_MS;
+    if (failures < 8) {
+        limit = RECONNECT_MIN_MS << (failures - 1);
+        if (limit > RECONNECT_MAX_MS) limit = RECONNECT_MAX_MS;
+    }
+
+    // xorshift32, seeded from the clock on first use
+    if (reconnect_rng == 0) reconnect_rng = (u32)osGetTime() | 1;
+    reconnect_rng ^= reconnect_rng << 13;
+    reconnect_rng ^= reconnect_rng >> 17;
+    reconnect_rng ^= reconnect_rng << 5;
+    return limit / 2 + (int)(reconnect_rng % (u32)(limit / 2 + 1));
+}
+
+// Whether to start a connection attempt now. A connection that drops is
+// retried at once; each attempt that fails after that backs off. Nothing
+// is tried while WiFi is down, and its return makes an attempt due at
+// once, abandoning one begun while the link was still going down.
+static bool reconnect_due(void) {
+    u64 now = osGetTime();
+    poll_wifi(now);
+    bool returned = wifi_returned;
+    wifi_returned = false;
+
+    NetworkPhase current = network_get_phase();
+    if (current == NET_CONNECTED) {
+        reconnect_failures = 0;
+        reconnect_pending = false;
+        reconnect_was_connected = true;
+        return false;
+    }
+    if (current != NET_IDLE) {
+        if (!returned) return false;
+        network_disconnect();
+        reconnect_pending = false;
+    }
 
-    cJSON* type = cJSON_GetObjectItem(root, "type");
-    if (type == NULL || !cJSON_IsString(type)) {
-        cJSON_Delete(root);
+    if (reconnect_was_connected) {
+        reconnect_was_connected = false;
+        reconnect_at = now;
+    } else if (reconnect_pending) {
+        reconnect_pending = false;
+        reconnect_failures++;
+        reconnect_at = now + backoff_ms(reconnect_failures);
+    }
+
+    if (!wifi_up) return false;
+    if (returned) {
+        reconnect_failures = 0;
+        reconnect_at = now;
+    }
+    if (now < reconnect_at) return false;
+
+    reconnect_pending = true;
+    stats.reconnects++;
+    return true;
+}
+
+bool network_reconnect_due(void) {
+    return reconnect_due();
+}
+
+int network_get_slot_count(void) {
+    return __atomic_load_n(&slot_count, __ATOMIC_RELAXED);
+}
+
+static bool wire_string_equals_nocase(const char* s, WireString w) {
+    return strncasecmp(s, w.str, w.len) == 0 && s[w.len] == '\0';
+}
+
+// Fields that live in AgentText
+#define TEXT_FIELDS (FIELD_BIT(FIELD_AGENT) | FIELD_BIT(FIELD_MESSAGE) | \
+                     FIELD_BIT(FIELD_PENDING_COMMAND) | FIELD_BIT(FIELD_PROMPT_TOOL_TYPE) | \
+                     FIELD_BIT(FIELD_PROMPT_TOOL_DETAIL) | FIELD_BIT(FIELD_PROMPT_DESCRIPTION))
+
+// Set a text field from msg if present, else clear it for a full status
+static bool apply_text(AgentText* text, AgentTextField field, unsigned int present,
+                       WireField wire, WireString value, bool full) {
+    if (present & FIELD_BIT(wire)) return agent_text_set(text, field, value.str, value.len);
+    if (full) return agent_text_set(text, field, "", 0);
+    return false;
+}
+
+// Copy the fields present in msg onto agent. A full agent_status describes
+// the whole slot, so optional fields it omits are cleared; a delta only
+// carries what changed and leaves everything else alone.
+// Returns true if anything visible changed; the server resends unchanged
+// fields in every full status.
+static bool apply_fields(Agent* agent, const WireMessage* msg, bool full) {
+    unsigned int present = msg->present;
+    Agent before = *agent;
+
+    if (present & FIELD_BIT(FIELD_ACTIVE)) agent->active = msg->active;
+    if (present & FIELD_BIT(FIELD_STATE)) agent->state = msg->state;
+    if (present & FIELD_BIT(FIELD_PROGRESS)) agent->progress = (int8_t)msg->progress;
+
+    if (present & FIELD_BIT(FIELD_CONTEXT_PERCENT)) {
+        agent->context_percent = (uint8_t)msg->context_percent;
+    } else if (full) {
+        agent->context_percent = 0;
+    }
+
+    // An empty tool type hides the prompt
+    if (present & FIELD_BIT(FIELD_PROMPT_TOOL_TYPE)) {
+        agent->prompt_visible = msg->prompt_tool_type.len > 0;
+    } else if (full) {
+        agent->prompt_visible = false;
+    }
+
+    bool changed = memcmp(&before, agent, sizeof(Agent)) != 0;
+
+    // Text is only allocated once a slot has some; clearing a slot that has
+    // none is a no-op
+    AgentText* text = (present & TEXT_FIELDS) ? agent_text_mut(agent) : agent->text;
+    if (text) {
+        changed |= apply_text(text, TEXT_NAME, present, FIELD_AGENT, msg->agent, false);
+        changed |= apply_text(text, TEXT_MESSAGE, present, FIELD_MESSAGE, msg->message, false);
+        changed |= apply_text(text, TEXT_PENDING_COMMAND, present, FIELD_PENDING_COMMAND,
+                              msg->pending_command, full);
+        changed |= apply_text(text, TEXT_TOOL_TYPE, present, FIELD_PROMPT_TOOL_TYPE,
+                              msg->prompt_tool_type, full);
+        changed |= apply_text(text, TEXT_TOOL_DETAIL, present, FIELD_PROMPT_TOOL_DETAIL,
+                              msg->prompt_tool_detail, full);
+        changed |= apply_text(text, TEXT_DESCRIPTION, present, FIELD_PROMPT_DESCRIPTION,
+                              msg->prompt_description, full);
+    }
+
+    // Sync auto-edit state from server. It reaches the main thread with the
+    // slot update, so a toggle counts as a change.
+    if ((present & FIELD_BIT(FIELD_AUTO_EDIT)) && server_auto_edit != msg->auto_edit) {
+        server_auto_edit = msg->auto_edit;
+        changed = true;
+    }
+    return changed;
+}
+
+// Ask the server for the full state of a slot after a missed delta.
+// Only one request per slot is outstanding; the full agent_status clears it.
+static void request_resync(int slot) {
+    if (resync_pending[slot]) return;
+    resync_pending[slot] = true;
+    slot_synced[slot] = false;
+
+    unsigned char buf[WS_WRITER_HEADER + 32];
+    WsWriter w;
+    ws_writer_begin(&w, buf, sizeof(buf), WS_OP_TEXT);
+    ws_writer_raw(&w, "{\"type\":\"resync\",\"slot\":");
+    ws_writer_int(&w, slot);
+    ws_writer_raw(&w, "}");
+
+    const unsigned char* frame;
+    int len;
+    if (ws_writer_end(&w, &frame, &len)) send_frame(frame, len);
+}
+
+// Apply an agent_delta if it is the next one for its slot, else resync
+static void apply_delta(const WireMessage* msg, Agent* agents, int agent_count) {
+    unsigned int required = FIELD_BIT(FIELD_SLOT) | FIELD_BIT(FIELD_SEQ);
+    if ((msg->present & required) != required) return;
+
+    int idx = msg->slot;
+    if (idx < 0 || idx >= slot_count) return;
+
+    if (idx >= agent_count || !slot_synced[idx] || msg->seq != slot_seq[idx] + 1) {
+        request_resync(idx);
+        return;
+    }
+
+    slot_seq[idx] = msg->seq;
+    if (apply_fields(&agents[idx], msg, false))
+        dirty_slots |= BIT(idx);
+}
+
+// Ascending order for qsort
+static int compare_int(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+// Record the round trip of an acknowledged action and refresh the percentiles
+static void record_ack(const WireMessage* msg) {
+    if (!(msg->present & FIELD_BIT(FIELD_CLIENT_MS))) return;
+    int rtt = (trace_clock_ms() - msg->client_ms) & 0x7FFFFFFF;
+    unsigned int acks = latency.acks + 1;
+    rtt_window[(acks - 1) % LATENCY_WINDOW] = rtt;
+
+    int n = acks < LATENCY_WINDOW ? (int)acks : LATENCY_WINDOW;
+    int sorted[LATENCY_WINDOW];
+    memcpy(sorted, rtt_window, n * sizeof(int));
+    qsort(sorted, n, sizeof(int), compare_int);
+
+    int server = (msg->present & FIELD_BIT(FIELD_SERVER_MS)) ? msg->server_ms : -1;
+    __atomic_store_n(&latency.last_ms, rtt, __ATOMIC_RELAXED);
+    __atomic_store_n(&latency.server_ms, server, __ATOMIC_RELAXED);
+    __atomic_store_n(&latency.p50_ms, sorted[(n - 1) * 50 / 100], __ATOMIC_RELAXED);
+    __atomic_store_n(&latency.p95_ms, sorted[(n - 1) * 95 / 100], __ATOMIC_RELAXED);
+    __atomic_store_n(&latency.p99_ms, sorted[(n - 1) * 99 / 100], __ATOMIC_RELAXED);
+    __atomic_store_n(&latency.acks, acks, __ATOMIC_RELEASE);
+}
+
+// Apply a decoded message (from either encoding) to the agents array
+static void apply_message(const WireMessage* msg, Agent* agents, int* agent_count) {
+    if (msg->type == MSG_ACTION_ACK) {
+        record_ack(msg);
         return;
     }
 
     // Handle spawn_result messages
-    if (strcmp(type->valuestring, "spawn_result") == 0) {
-        cJSON* slotJ = cJSON_GetObjectItem(root, "slot");
-        cJSON* successJ = cJSON_GetObjectItem(root, "success");
-        if (slotJ && cJSON_IsNumber(slotJ) && successJ && cJSON_IsTrue(successJ)) {
-            int slot = slotJ->valueint;
-            if (slot >= 0 && slot < MAX_AGENTS) {
+    if (msg->type == MSG_SPAWN_RESULT) {
+        if ((msg->present & FIELD_BIT(FIELD_SLOT)) && msg->success) {
+            int slot = msg->slot;
+            if (slot >= 0 && slot < slot_count) {
                 agents[slot].spawning = true;
-                agents[slot].spawn_anim_frame = 0;
+                dirty_slots |= BIT(slot);
             }
         }
-        cJSON_Delete(root);
         return;
     }
 
-    // Handle agent_status messages
-    if (strcmp(type->valuestring, "agent_status") != 0) {
-        cJSON_Delete(root);
+    if (msg->type == MSG_AGENT_DELTA) {
+        apply_delta(msg, agents, *agent_count);
         return;
     }
 
-    cJSON* agent_name = cJSON_GetObjectItem(root, "agent");
-    cJSON* state = cJSON_GetObjectItem(root, "state");
-    cJSON* progress = cJSON_GetObjectItem(root, "progress");
-    cJSON* message = cJSON_GetObjectItem(root, "message");
-    cJSON* pending = cJSON_GetObjectItem(root, "pendingCommand");
-    cJSON* slotJ = cJSON_GetObjectItem(root, "slot");
-    cJSON* activeJ = cJSON_GetObjectItem(root, "active");
-
-    if (agent_name == NULL) {
-        cJSON_Delete(root);
-        return;
-    }
+    // Handle agent_status messages
+    if (msg->type != MSG_AGENT_STATUS) return;
+    if (!(msg->present & FIELD_BIT(FIELD_AGENT))) return;
 
     // Use slot field if available, otherwise find by name
     int idx = -1;
-    if (slotJ && cJSON_IsNumber(slotJ)) {
-        idx = slotJ->valueint;
-        if (idx < 0 || idx >= MAX_AGENTS) {
-            cJSON_Delete(root);
-            return;
-        }
+    if (msg->present & FIELD_BIT(FIELD_SLOT)) {
+        idx = msg->slot;
+        if (idx < 0 || idx >= slot_count) return;
         // Ensure agent_count covers this slot
         if (idx >= *agent_count) {
             // Initialize slots between current count and this slot
             for (int i = *agent_count; i <= idx; i++) {
-                memset(&agents[i], 0, sizeof(Agent));
-                agents[i].state = STATE_IDLE;
-                agents[i].progress = -1;
-                agents[i].slot = i;
+                agent_clear(&agents[i], i);
+                dirty_slots |= BIT(i);
             }
             *agent_count = idx + 1;
         }
     } else {
         // Legacy: find by name
         for (int i = 0; i < *agent_count; i++) {
-            if (strcasecmp(agents[i].name, agent_name->valuestring) == 0) {
+            if (wire_string_equals_nocase(agent_text(&agents[i])->name, msg->agent)) {
                 idx = i;
                 break;
             }
         }
-        if (idx < 0 && *agent_count < MAX_AGENTS) {
+        if (idx < 0 && *agent_count < slot_count) {
             idx = (*agent_count)++;
         }
     }
 
-    if (idx < 0) {
-        cJSON_Delete(root);
-        return;
+    if (idx < 0) return;
+    Agent* agent = &agents[idx];
+    agent->slot = idx;
+    if (apply_fields(agent, msg, true))
+        dirty_slots |= BIT(idx);
+
+    // A full status is the baseline that following deltas build on
+    if ((msg->present & FIELD_BIT(FIELD_SLOT)) && (msg->present & FIELD_BIT(FIELD_SEQ))) {
+        slot_seq[idx] = msg->seq;
+        slot_synced[idx] = true;
+        resync_pending[idx] = false;
     }
+}
 
-    // Update agent name
-    strncpy(agents[idx].name, agent_name->valuestring, sizeof(agents[idx].name) - 1);
-    agents[idx].name[sizeof(agents[idx].name) - 1] = '\0';
-    agents[idx].slot = idx;
+// The cJSON path: messages json_decode turned down. skip is the number of
+// batch entries already applied from the fast path.
+static void parse_message_tree(const char* json, int len, Agent* agents, int* agent_count,
+                               int skip) {
+    stats.json_fallbacks++;
+    cJSON* root = json_arena_parse(json, len);
+    if (root == NULL) {
+        json_arena_release(NULL);  // drop whatever the failed parse allocated
+        return;
+    }
 
-    // Update active flag
-    if (activeJ && cJSON_IsBool(activeJ)) {
-        agents[idx].active = cJSON_IsTrue(activeJ);
+    WireMessage msg;
+    if (json_decode_tree(root, &msg)) {
+        if (msg.type == MSG_SLOT_BATCH) {
+            // {"type":"batch","messages":[...]}: apply each entry in order
+            cJSON* entries = cJSON_GetObjectItemCaseSensitive(root, "messages");
+            cJSON* entry;
+            cJSON_ArrayForEach(entry, entries) {
+                if (skip > 0) {
+                    skip--;
+                    continue;
+                }
+                if (json_decode_tree(entry, &msg) && msg.type != MSG_SLOT_BATCH) {
+                    apply_message(&msg, agents, agent_count);
+                }
+            }
+        } else {
+            apply_message(&msg, agents, agent_count);
+        }
     }
+    json_arena_release(root);
+}
 
-    // Update agent state
-    if (state && cJSON_IsString(state)) {
-        const char* s = state->valuestring;
-        if (strcmp(s, "working") == 0) agents[idx].state = STATE_WORKING;
-        else if (strcmp(s, "waiting") == 0) agents[idx].state = STATE_WAITING;
-        else if (strcmp(s, "error") == 0) agents[idx].state = STATE_ERROR;
-        else if (strcmp(s, "done") == 0) agents[idx].state = STATE_DONE;
-        else agents[idx].state = STATE_IDLE;
+static void parse_message(const char* json, int len, Agent* agents, int* agent_count) {
+    WireMessage msg;
+    WireString entries;
+    if (!json_decode(json, len, &msg, &entries, json_scratch, sizeof(json_scratch))) {
+        parse_message_tree(json, len, agents, agent_count, 0);
+        return;
     }
-    if (progress) agents[idx].progress = progress->valueint;
-    if (message && cJSON_IsString(message)) {
-        strncpy(agents[idx].message, message->valuestring, sizeof(agents[idx].message) - 1);
+    if (msg.type != MSG_SLOT_BATCH) {
+        apply_message(&msg, agents, agent_count);
+        return;
     }
-    if (pending && cJSON_IsString(pending)) {
-        strncpy(agents[idx].pending_command, pending->valuestring, sizeof(agents[idx].pending_command) - 1);
-    } else {
-        agents[idx].pending_command[0] = '\0';
+
+    int pos = 0;
+    int applied = 0;
+    while (json_batch_next(entries, &pos, &msg, json_scratch, sizeof(json_scratch))) {
+        if (msg.type != MSG_SLOT_BATCH) apply_message(&msg, agents, agent_count);
+        applied++;
     }
+    // An entry the fast path can't decode sends the rest of the batch to cJSON
+    if (pos != entries.len) parse_message_tree(json, len, agents, agent_count, applied);
+}
 
-    cJSON* context = cJSON_GetObjectItem(root, "contextPercent");
-    agents[idx].context_percent = (context && cJSON_IsNumber(context)) ? context->valueint : 0;
+typedef struct {
+    bool fin;
+    int opcode;
+    bool masked;
+    unsigned long long payload_len;
+    int header_len;
+} WsHeader;
 
-    // Parse prompt fields
-    cJSON* promptToolType = cJSON_GetObjectItem(root, "promptToolType");
-    cJSON* promptToolDetail = cJSON_GetObjectItem(root, "promptToolDetail");
-    cJSON* promptDescription = cJSON_GetObjectItem(root, "promptDescription");
+// Decode a frame header. Returns false if more bytes are needed.
+static bool parse_ws_header(const unsigned char* data, int len, WsHeader* h) {
+    if (len < 2) return false;
 
-    if (promptToolType && cJSON_IsString(promptToolType) && promptToolType->valuestring[0] != '\0') {
-        agents[idx].prompt_visible = true;
-        strncpy(agents[idx].prompt_tool_type, promptToolType->valuestring, sizeof(agents[idx].prompt_tool_type) - 1);
-        agents[idx].prompt_tool_type[sizeof(agents[idx].prompt_tool_type) - 1] = '\0';
-    } else {
-        agents[idx].prompt_visible = false;
-        agents[idx].prompt_tool_type[0] = '\0';
+    h->fin = (data[0] & 0x80) != 0;
+    h->opcode = data[0] & 0x0F;
+    h->masked = (data[1] & 0x80) != 0;
+    h->payload_len = data[1] & 0x7F;
+    h->header_len = 2;
+
+    if (h->payload_len == 126) {
+        if (len < 4) return false;
+        h->payload_len = (data[2] << 8) | data[3];
+        h->header_len = 4;
+    } else if (h->payload_len == 127) {
+        if (len < 10) return false;
+        h->payload_len = 0;
+        for (int i = 0; i < 8; i++) {
+            h->payload_len = (h->payload_len << 8) | data[2 + i];
+        }
+        h->header_len = 10;
     }
 
-    if (promptToolDetail && cJSON_IsString(promptToolDetail)) {
-        strncpy(agents[idx].prompt_tool_detail, promptToolDetail->valuestring, sizeof(agents[idx].prompt_tool_detail) - 1);
-        agents[idx].prompt_tool_detail[sizeof(agents[idx].prompt_tool_detail) - 1] = '\0';
+    if (h->masked) h->header_len += 4;
+    return len >= h->header_len;
+}
+
+void network_handle_message(bool binary, const char* payload, int len, Agent* agents, int* agent_count) {
+    stats.messages++;
+    if (binary) {
+        const unsigned char* data = (const unsigned char*)payload;
+        WireMessage msg;
+        if (!codec_decode(data, len, &msg)) return;
+        if (msg.type != MSG_SLOT_BATCH) {
+            apply_message(&msg, agents, agent_count);
+            return;
+        }
+
+        const unsigned char* entry;
+        int entry_len;
+        int pos = 0;
+        while (codec_batch_next(data, len, &pos, &entry, &entry_len)) {
+            if (codec_decode(entry, entry_len, &msg) && msg.type != MSG_SLOT_BATCH) {
+                apply_message(&msg, agents, agent_count);
+            }
+        }
     } else {
-        agents[idx].prompt_tool_detail[0] = '\0';
+        parse_message(payload, len, agents, agent_count);
     }
+}
 
-    if (promptDescription && cJSON_IsString(promptDescription)) {
-        strncpy(agents[idx].prompt_description, promptDescription->valuestring, sizeof(agents[idx].prompt_description) - 1);
-        agents[idx].prompt_description[sizeof(agents[idx].prompt_description) - 1] = '\0';
+// Deliver a complete data message
+static void handle_message(int opcode, const char* payload, int len, Agent* agents, int* agent_count) {
+    if (opcode != WS_OP_TEXT && opcode != WS_OP_BINARY) return;
+    network_handle_message(opcode == WS_OP_BINARY, payload, len, agents, agent_count);
+}
+
+// Time a pong answering one of our pings (payload: the client clock when
+// it was sent, big-endian). Unsolicited pongs are allowed and ignored.
+static void record_pong(const unsigned char* payload, int len) {
+    if (len != 4) return;
+    int sent = (int)(((unsigned int)payload[0] << 24) | (payload[1] << 16) |
+                     (payload[2] << 8) | payload[3]);
+    int rtt = (trace_clock_ms() - sent) & 0x7FFFFFFF;
+    if (rtt > HEARTBEAT_TIMEOUT_MS) return;  // not ours, or from a clock reset
+
+    if (srtt8 < 0) {
+        srtt8 = rtt * 8;
+        rttvar4 = rtt * 2;
     } else {
-        agents[idx].prompt_description[0] = '\0';
+        int err = rtt - srtt8 / 8;
+        srtt8 += err;                                    // srtt += err / 8
+        rttvar4 += (err < 0 ? -err : err) - rttvar4 / 4; // rttvar += (|err| - rttvar) / 4
     }
+    __atomic_store_n(&link_rtt_ms, srtt8 / 8, __ATOMIC_RELAXED);
+}
 
-    // Sync auto-edit state from server
-    cJSON* autoEdit = cJSON_GetObjectItem(root, "autoEdit");
-    if (autoEdit && cJSON_IsBool(autoEdit)) {
-        server_auto_edit = cJSON_IsTrue(autoEdit);
+// Ping the server every HEARTBEAT_INTERVAL_MS and drop a connection that
+// has been silent for HEARTBEAT_TIMEOUT_MS, so a dead link is noticed in
+// seconds rather than whenever TCP gives up on it
+static void heartbeat(void) {
+    u64 now = osGetTime();
+    if (now - last_received > HEARTBEAT_TIMEOUT_MS) {
+        printf("No data from server for %d ms, reconnecting\n", (int)(now - last_received));
+        stats.heartbeat_timeouts++;
+        close_connection(WS_CLOSE_NORMAL);
+        return;
+    }
+    if (now - last_ping >= HEARTBEAT_INTERVAL_MS) {
+        last_ping = now;
+        unsigned int t = (unsigned int)trace_clock_ms();
+        unsigned char payload[4] = { t >> 24, (t >> 16) & 0xFF, (t >> 8) & 0xFF, t & 0xFF };
+        send_ws_frame_op(WS_OP_PING, payload, sizeof(payload));
+    }
+}
+
+static void handle_control_frame(int opcode, const unsigned char* payload, int len) {
+    switch (opcode) {
+        case WS_OP_PING:
+            send_ws_frame_op(WS_OP_PONG, payload, len);
+            break;
+        case WS_OP_PONG:
+            record_pong(payload, len);
+            break;
+        case WS_OP_CLOSE: {
+            // Echo the server's status code back, then drop the connection
+            int code = (len >= 2) ? ((payload[0] << 8) | payload[1]) : WS_CLOSE_NORMAL;
+            close_connection(code);
+            break;
+        }
+        default:
+            break;
     }
+}
 
-    cJSON_Delete(root);
+static bool reserve_msg_buf(int needed) {
+    if (needed <= msg_cap) return true;
+    int cap = msg_cap ? msg_cap : RECV_BUF_SIZE;
+    while (cap < needed) cap *= 2;
+    char* grown = realloc(msg_buf, cap);
+    if (grown == NULL) return false;
+    msg_buf = grown;
+    msg_cap = cap;
+    return true;
 }
 
-static void process_ws_frame(const unsigned char* data, int len, Agent* agents, int* agent_count) {
-    if (len < 2) return;
+// Decode every frame available in recv_buf. Complete single-frame messages
+// that fit in recv_buf are parsed in place; fragmented or oversized ones are
+// streamed into msg_buf as their bytes arrive.
+static void process_ws_frames(Agent* agents, int* agent_count) {
+    while (sock >= 0 && recv_head < recv_tail) {
+        const unsigned char* data = (const unsigned char*)recv_buf + recv_head;
+        int available = recv_tail - recv_head;
 
-    // Simple WebSocket frame parsing (assumes small, unfragmented, text frames)
-    int opcode = data[0] & 0x0F;
-    int payload_len = data[1] & 0x7F;
-    int offset = 2;
+        // Continue copying the payload of a streamed frame
+        if (frame_remaining > 0) {
+            int n = (available < frame_remaining) ? available : frame_remaining;
+            memcpy(msg_buf + msg_len, data, n);
+            stats.bytes_copied += n;
+            msg_len += n;
+            frame_remaining -= n;
+            recv_head += n;
+            if (frame_remaining == 0 && frame_fin) {
+                handle_message(msg_opcode, msg_buf, msg_len, agents, agent_count);
+                reset_message();
+            }
+            continue;
+        }
 
-    if (payload_len == 126) {
-        if (len < 4) return;
-        payload_len = (data[2] << 8) | data[3];
-        offset = 4;
-    }
+        WsHeader h;
+        if (!parse_ws_header(data, available, &h)) break;
+
+        // Servers must not mask frames
+        if (h.masked) {
+            close_connection(WS_CLOSE_PROTOCOL);
+            return;
+        }
+        if (h.payload_len > MAX_MESSAGE_SIZE) {
+            close_connection(WS_CLOSE_TOO_BIG);
+            return;
+        }
+        int payload_len = (int)h.payload_len;
+        int frame_len = h.header_len + payload_len;
+
+        // Control frames are small, unfragmented, and may arrive mid-message
+        if (h.opcode >= WS_OP_CLOSE) {
+            if (!h.fin || payload_len > 125) {
+                close_connection(WS_CLOSE_PROTOCOL);
+                return;
+            }
+            if (available < frame_len) break;
+            recv_head += frame_len;
+            handle_control_frame(h.opcode, data + h.header_len, payload_len);
+            continue;
+        }
+
+        // A continuation must follow an unfinished message, anything else must not
+        bool continuation = (h.opcode == WS_OP_CONTINUATION);
+        if (continuation != (msg_opcode >= 0)) {
+            close_connection(WS_CLOSE_PROTOCOL);
+            return;
+        }
+
+        // Fast path: whole message in one frame that fits recv_buf — parse in place
+        if (h.fin && !continuation && frame_len <= RECV_BUF_SIZE) {
+            if (available < frame_len) break;
+            recv_head += frame_len;
+            handle_message(h.opcode, (const char*)data + h.header_len, payload_len, agents, agent_count);
+            continue;
+        }
 
-    if (opcode == 0x01 && offset + payload_len <= len) {  // Text frame
-        char json[RECV_BUF_SIZE];
-        memcpy(json, data + offset, payload_len);
-        json[payload_len] = '\0';
-        parse_message(json, agents, agent_count);
+        // Slow path: reassemble into msg_buf
+        if (!continuation) {
+            msg_opcode = h.opcode;
+            msg_len = 0;
+        }
+        if (msg_len + payload_len > MAX_MESSAGE_SIZE || !reserve_msg_buf(msg_len + payload_len)) {
+            close_connection(WS_CLOSE_TOO_BIG);
+            return;
+        }
+        recv_head += h.header_len;
+        frame_remaining = payload_len;
+        frame_fin = h.fin;
+        if (frame_remaining == 0 && frame_fin) {
+            handle_message(msg_opcode, msg_buf, msg_len, agents, agent_count);
+            reset_message();
+        }
     }
 }
 
-void network_poll(Agent* agents, int* agent_count) {
-    if (sock < 0) return;
+// Move a pending partial frame to the front of recv_buf to make room
+static void compact_recv_buf(void) {
+    int pending = recv_tail - recv_head;
+    memmove(recv_buf, recv_buf + recv_head, pending);
+    stats.bytes_copied += pending;
+    recv_head = 0;
+    recv_tail = pending;
+}
+
+// Receive and apply everything available on the socket (the inline path,
+// and the body of the worker loop)
+static void poll_socket(Agent* agents, int* agent_count) {
+    advance_connect();
+    if (phase != NET_HANDSHAKE && phase != NET_CONNECTED) return;
+
+    if (recv_head == recv_tail) {
+        recv_head = 0;
+        recv_tail = 0;
+    } else if (recv_tail == RECV_BUF_SIZE && recv_head > 0) {
+        compact_recv_buf();
+    }
 
     // Try to receive data
-    int space = RECV_BUF_SIZE - recv_buf_len - 1;
+    int space = RECV_BUF_SIZE - recv_tail;
     if (space > 0) {
-        int n = recv(sock, recv_buf + recv_buf_len, space, 0);
+        int n = recv(sock, recv_buf + recv_tail, space, 0);
         if (n > 0) {
-            recv_buf_len += n;
-            recv_buf[recv_buf_len] = '\0';
+            recv_tail += n;
+            recv_buf[recv_tail] = '\0';
+            stats.bytes_received += n;
+            last_received = osGetTime();
         } else if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
             // Connection closed or error
-            connected = false;
+            close_connection(WS_CLOSE_NORMAL);
             return;
         }
     }
 
     // Check for WebSocket handshake response
-    if (!ws_handshake_done) {
-        char* end = strstr(recv_buf, "\r\n\r\n");
+    if (phase == NET_HANDSHAKE) {
+        char* start = recv_buf + recv_head;
+        char* end = strstr(start, "\r\n\r\n");
         if (end) {
-            if (strstr(recv_buf, "101") != NULL) {
-                ws_handshake_done = true;
-                int handshake_len = (end - recv_buf) + 4;
-                memmove(recv_buf, recv_buf + handshake_len, recv_buf_len - handshake_len);
-                recv_buf_len -= handshake_len;
+            if (strstr(start, "101") != NULL) {
+                __atomic_store_n(&slot_count, parse_slot_count(start, end), __ATOMIC_RELAXED);
+                accept_server_epoch(start, end);
+                set_phase(NET_CONNECTED);
+                last_ping = last_received;
+                recv_head += (end - start) + 4;
             } else {
                 // Handshake failed
                 network_disconnect();
@@ -323,82 +1147,315 @@ void network_poll(Agent* agents, int* agent_count) {
         return;
     }
 
-    // Process WebSocket frames
-    while (recv_buf_len >= 2) {
-        int payload_len = recv_buf[1] & 0x7F;
-        int header_len = 2;
-        if (payload_len == 126) header_len = 4;
+    process_ws_frames(agents, agent_count);
+    if (phase == NET_CONNECTED) heartbeat();
 
-        if (recv_buf_len < header_len) break;
-        if (payload_len == 126) {
-            payload_len = ((unsigned char)recv_buf[2] << 8) | (unsigned char)recv_buf[3];
-        }
+    // Pongs and resync requests from this poll, plus anything a short write
+    // left over, in one send
+    if (sock >= 0 && !flush_out()) close_connection(WS_CLOSE_NORMAL);
+}
+
+// ========== Worker thread ==========
+//
+// With network_start_thread the socket, frame decoding and JSON parsing all
+// run on a worker thread. It applies messages to its own copy of the agents
+// and publishes each changed slot as a snapshot through update_queue; the
+// main thread only copies snapshots in network_poll. Outgoing messages take
+// send_queue the other way. Both rings are lock-free SPSC (spsc.h).
+
+// A slot snapshot carries its text by value: each thread keeps its own
+// AgentText allocations and only the ring is shared. The text (most of
+// the snapshot) is only copied when a field changed since the slot was
+// last published; otherwise the main thread keeps the text it has.
+typedef struct {
+    int slot;
+    int agent_count;
+    bool auto_edit;
+    bool spawned;          // spawn event, ORed into agent.spawning on drain
+    bool has_text;         // text is set; otherwise unchanged
+    Agent agent;           // text is NULL here, see below
+    AgentText text;
+} AgentUpdate;
+
+// A finished frame, written in place by the main thread (see begin_message)
+typedef struct {
+    int offset;            // of the frame in buf
+    int len;
+    unsigned char buf[SEND_BUF_SIZE];
+} QueuedMessage;
+
+static Thread worker_thread = NULL;
+static bool worker_stop = false;
+static SpscRing update_queue;
+static SpscRing send_queue;
+static AgentUpdate update_slots[UPDATE_QUEUE_SIZE];
+static QueuedMessage send_slots[SEND_QUEUE_SIZE];
+static Agent worker_agents[MAX_AGENTS];
+static int worker_agent_count = 0;
+static char worker_host[64];
+static int worker_port = 0;
+static bool main_auto_edit = false;   // auto-edit as last seen by the main thread
+
+// Hashes and lengths of each slot's text fields as last published
+static u32 published_hash[MAX_AGENTS][TEXT_FIELD_COUNT];
+static u16 published_len[MAX_AGENTS][TEXT_FIELD_COUNT];
+
+// Whether slot's text differs from what the main thread last got, and if
+// so note it as published
+static bool take_text_change(int slot) {
+    const AgentText* text = agent_text(&worker_agents[slot]);
+    if (memcmp(published_hash[slot], text->hash, sizeof(published_hash[slot])) == 0 &&
+        memcmp(published_len[slot], text->len, sizeof(published_len[slot])) == 0) {
+        return false;
+    }
+    memcpy(published_hash[slot], text->hash, sizeof(published_hash[slot]));
+    memcpy(published_len[slot], text->len, sizeof(published_len[slot]));
+    return true;
+}
+
+// Publish dirty slots. A full queue leaves them dirty, so a burst collapses
+// into the latest state of each slot once the main thread catches up.
+static void publish_updates(void) {
+    for (int i = 0; i < MAX_AGENTS && dirty_slots; i++) {
+        if (!(dirty_slots & BIT(i))) continue;
+        AgentUpdate* update = spsc_reserve(&update_queue);
+        if (update == NULL) return;
+        update->slot = i;
+        update->agent_count = worker_agent_count;
+        update->auto_edit = server_auto_edit;
+        update->agent = worker_agents[i];
+        update->agent.text = NULL;
+        update->has_text = take_text_change(i);
+        if (update->has_text) update->text = *agent_text(&worker_agents[i]);
+        update->spawned = worker_agents[i].spawning;
+        spsc_commit(&update_queue);
+        worker_agents[i].spawning = false;  // an event, delivered once
+        dirty_slots &= ~BIT(i);
+    }
+}
+
+// Move queued frames into out_buf and send them together. Frames that
+// don't fit behind a backed-up socket wait in the ring for the next pass.
+static void flush_send_queue(void) {
+    QueuedMessage* msg;
+    while ((msg = spsc_peek(&send_queue)) != NULL) {
+        if (!queue_out(msg->buf + msg->offset, msg->len)) break;
+        spsc_release(&send_queue);
+    }
+    if (!flush_out()) close_connection(WS_CLOSE_NORMAL);
+}
 
-        int frame_len = header_len + payload_len;
-        if (recv_buf_len < frame_len) break;
+static void worker_main(void* arg) {
+    (void)arg;
+    while (!__atomic_load_n(&worker_stop, __ATOMIC_ACQUIRE)) {
+        if (reconnect_due()) {
+            network_connect(worker_host, worker_port);
+        }
 
-        process_ws_frame((unsigned char*)recv_buf, frame_len, agents, agent_count);
+        poll_socket(worker_agents, &worker_agent_count);
+        publish_updates();
+        if (phase == NET_CONNECTED) {
+            flush_send_queue();
+        }
 
-        memmove(recv_buf, recv_buf + frame_len, recv_buf_len - frame_len);
-        recv_buf_len -= frame_len;
+        // Sleep until data arrives or a backed-up socket can take more
+        // (or briefly, to pick up queued sends)
+        if (sock >= 0 && phase >= NET_CONNECTING) {
+            short events = POLLIN;
+            if (phase == NET_CONNECTING) {
+                events = POLLOUT;
+            } else if (out_head < out_tail) {
+                events |= POLLOUT;
+            }
+            struct pollfd pfd = { .fd = sock, .events = events };
+            poll(&pfd, 1, WORKER_WAIT_MS);
+        } else {
+            svcSleepThread(WORKER_WAIT_MS * 1000000LL);
+        }
     }
 }
 
-static void send_ws_frame(const char* data) {
-    if (sock < 0 || !ws_handshake_done) return;
+bool network_start_thread(const char* host, int port) {
+    if (worker_thread != NULL) return true;
+
+    spsc_init(&update_queue, update_slots, sizeof(AgentUpdate), UPDATE_QUEUE_SIZE);
+    spsc_init(&send_queue, send_slots, sizeof(QueuedMessage), SEND_QUEUE_SIZE);
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        agent_clear(&worker_agents[i], i);
+    }
+    worker_agent_count = 0;
+    dirty_slots = 0;
+    // No length matches, so each slot's first snapshot carries its text
+    memset(published_len, 0xFF, sizeof(published_len));
+    main_auto_edit = server_auto_edit;
+    snprintf(worker_host, sizeof(worker_host), "%s", host);
+    worker_port = port;
+    server_epoch = 0;      // the worker's agents start empty
+    worker_stop = false;
 
-    int len = strlen(data);
-    unsigned char frame[SEND_BUF_SIZE];
-    int offset = 0;
+    // Prefer the New 3DS's extra core; elsewhere share the app core at a
+    // lower priority, so the worker runs while rendering waits for vblank
+    s32 prio = 0x30;
+    svcGetThreadPriority(&prio, CUR_THREAD_HANDLE);
+    worker_thread = threadCreate(worker_main, NULL, WORKER_STACK_SIZE, prio - 1, 2, false);
+    if (worker_thread == NULL) {
+        worker_thread = threadCreate(worker_main, NULL, WORKER_STACK_SIZE, prio + 1, -2, false);
+    }
+    return worker_thread != NULL;
+}
+
+void network_stop_thread(void) {
+    if (worker_thread == NULL) return;
+    __atomic_store_n(&worker_stop, true, __ATOMIC_RELEASE);
+    threadJoin(worker_thread, U64_MAX);
+    threadFree(worker_thread);
+    worker_thread = NULL;
+    network_disconnect();
+    for (int i = 0; i < MAX_AGENTS; i++) {
+        agent_free(&worker_agents[i]);
+    }
+}
 
-    frame[offset++] = 0x81;  // FIN + text opcode
+// Copy published slot snapshots into the caller's agents.
+// Returns the mask of slots that had one.
+static unsigned int drain_updates(Agent* agents, int* agent_count) {
+    unsigned int changed = 0;
+    AgentUpdate* update;
+    while ((update = spsc_peek(&update_queue)) != NULL) {
+        changed |= BIT(update->slot);
+        Agent* agent = &agents[update->slot];
+        // A later update for the slot must not cancel a spawn main hasn't
+        // seen yet; main.c clears the flag once it plays the animation
+        bool spawning = agent->spawning || update->spawned;
+        AgentText* text = agent->text;
+        *agent = update->agent;
+        agent->text = text;
+        agent->spawning = spawning;
+        if (update->has_text && agent_text_mut(agent)) {
+            *agent->text = update->text;
+        }
+        if (update->agent_count > *agent_count) {
+            *agent_count = update->agent_count;
+        }
+        main_auto_edit = update->auto_edit;
+        spsc_release(&update_queue);
+    }
+    return changed;
+}
 
-    // Mask bit set (required from client), followed by length
-    if (len < 126) {
-        frame[offset++] = 0x80 | len;
+unsigned int network_poll(Agent* agents, int* agent_count) {
+    unsigned int changed;
+    if (worker_thread != NULL) {
+        changed = drain_updates(agents, agent_count);
     } else {
-        frame[offset++] = 0x80 | 126;
-        frame[offset++] = (len >> 8) & 0xFF;
-        frame[offset++] = len & 0xFF;
+        // Inline, the dirty bits are handed straight to the caller
+        poll_socket(agents, agent_count);
+        changed = dirty_slots;
+        dirty_slots = 0;
     }
+    // A server that came back with fewer slots drops the ones past its count
+    int slots = network_get_slot_count();
+    if (*agent_count > slots) *agent_count = slots;
+    return changed;
+}
 
-    // Masking key (just use zeros for simplicity, though spec says random)
-    unsigned char mask[4] = {0x12, 0x34, 0x56, 0x78};
-    memcpy(frame + offset, mask, 4);
-    offset += 4;
+// Outgoing messages are written straight into the buffer they are sent
+// from: send_buf inline, or the next free send_queue slot when the worker
+// owns the socket. Like the inline path, the worker path drops rather than
+// delivers late after a reconnect.
+static unsigned char send_buf[SEND_BUF_SIZE];
 
-    // Masked payload
-    for (int i = 0; i < len; i++) {
-        frame[offset++] = data[i] ^ mask[i % 4];
+static bool begin_message(WsWriter* w) {
+    if (!network_is_connected()) return false;
+    if (worker_thread == NULL) {
+        ws_writer_begin(w, send_buf, sizeof(send_buf), WS_OP_TEXT);
+        return true;
     }
+    QueuedMessage* msg = spsc_reserve(&send_queue);
+    if (msg == NULL) {
+        printf("Send queue full, dropping message\n");
+        return false;
+    }
+    ws_writer_begin(w, msg->buf, sizeof(msg->buf), WS_OP_TEXT);
+    return true;
+}
 
-    send(sock, frame, offset, 0);
+// Send now, or hand the slot begin_message wrote into to the worker
+static void finish_message(WsWriter* w) {
+    const unsigned char* frame;
+    int len;
+    if (!ws_writer_end(w, &frame, &len)) {
+        printf("Message too long (%d bytes), dropping\n", w->len);
+        return;
+    }
+    // Inline, send right away rather than on the next poll
+    if (worker_thread == NULL) {
+        send_frame(frame, len);
+        if (!flush_out()) close_connection(WS_CLOSE_NORMAL);
+        return;
+    }
+    QueuedMessage* msg = spsc_reserve(&send_queue);
+    msg->offset = (int)(frame - msg->buf);
+    msg->len = len;
+    spsc_commit(&send_queue);
 }
 
+// Actions carry a trace id and the client clock; the server echoes both
+// in an action_ack once the keystrokes are sent (see record_ack)
 void network_send_action(const char* agent, const char* action) {
-    char json[256];
-    snprintf(json, sizeof(json),
-        "{\"type\":\"action\",\"agent\":\"%s\",\"action\":\"%s\",\"slot\":0}",
-        agent, action);
-    send_ws_frame(json);
+    WsWriter w;
+    if (!begin_message(&w)) return;
+    ws_writer_raw(&w, "{\"type\":\"action\",\"agent\":");
+    ws_writer_string(&w, agent);
+    ws_writer_raw(&w, ",\"action\":");
+    ws_writer_string(&w, action);
+    ws_writer_raw(&w, ",\"slot\":0,\"id\":");
+    ws_writer_int(&w, next_trace_id++);
+    ws_writer_raw(&w, ",\"clientMs\":");
+    ws_writer_int(&w, trace_clock_ms());
+    ws_writer_raw(&w, "}");
+    finish_message(&w);
 }
 
 void network_send_command(const char* agent, const char* command) {
-    char json[256];
-    snprintf(json, sizeof(json),
-        "{\"type\":\"command\",\"agent\":\"%s\",\"command\":\"%s\",\"slot\":0}",
-        agent, command);
-    send_ws_frame(json);
+    WsWriter w;
+    if (!begin_message(&w)) return;
+    ws_writer_raw(&w, "{\"type\":\"command\",\"agent\":");
+    ws_writer_string(&w, agent);
+    ws_writer_raw(&w, ",\"command\":");
+    ws_writer_string(&w, command);
+    ws_writer_raw(&w, ",\"slot\":0}");
+    finish_message(&w);
 }
 
 void network_send_config(const char* agent, bool auto_edit) {
-    char json[256];
-    snprintf(json, sizeof(json),
-        "{\"type\":\"config\",\"agent\":\"%s\",\"autoEdit\":%s}",
-        agent, auto_edit ? "true" : "false");
-    send_ws_frame(json);
+    WsWriter w;
+    if (!begin_message(&w)) return;
+    ws_writer_raw(&w, "{\"type\":\"config\",\"agent\":");
+    ws_writer_string(&w, agent);
+    ws_writer_raw(&w, ",\"autoEdit\":");
+    ws_writer_bool(&w, auto_edit);
+    ws_writer_raw(&w, "}");
+    finish_message(&w);
+}
+
+int network_get_rtt(void) {
+    return __atomic_load_n(&link_rtt_ms, __ATOMIC_RELAXED);
+}
+
+void network_get_latency(NetworkLatency* out) {
+    out->acks = __atomic_load_n(&latency.acks, __ATOMIC_ACQUIRE);
+    out->last_ms = __atomic_load_n(&latency.last_ms, __ATOMIC_RELAXED);
+    out->server_ms = __atomic_load_n(&latency.server_ms, __ATOMIC_RELAXED);
+    out->p50_ms = __atomic_load_n(&latency.p50_ms, __ATOMIC_RELAXED);
+    out->p95_ms = __atomic_load_n(&latency.p95_ms, __ATOMIC_RELAXED);
+    out->p99_ms = __atomic_load_n(&latency.p99_ms, __ATOMIC_RELAXED);
 }
 
 bool network_get_auto_edit(void) {
-    return server_auto_edit;
+    return worker_thread != NULL ? main_auto_edit : server_auto_edit;
+}
+
+const NetworkStats* network_get_stats(void) {
+    return &stats;
 }
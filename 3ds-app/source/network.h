@@ -4,6 +4,44 @@
 #include <stdbool.h>
 #include "protocol.h"
 
+// Connection lifecycle. network_connect starts at RESOLVING (or CONNECTING
+// for numeric/cached addresses); network_poll advances it without blocking.
+// A failed or dropped connection goes back to NET_IDLE.
+typedef enum {
+    NET_IDLE = 0,       // not connected, no attempt in progress
+    NET_RESOLVING,      // host name lookup on a worker thread
+    NET_CONNECTING,     // TCP connect in progress
+    NET_HANDSHAKE,      // waiting for the WebSocket upgrade response
+    NET_CONNECTED,
+} NetworkPhase;
+
+// Socket counters (cumulative since startup)
+typedef struct {
+    unsigned int messages;        // WebSocket data frames handed to the parser
+    unsigned int bytes_received;  // bytes read from the socket
+    unsigned int bytes_copied;    // bytes moved by compaction or fragment reassembly
+    unsigned int json_fallbacks;  // JSON messages json_decode left to cJSON
+    unsigned int bytes_sent;      // bytes the socket accepted
+    unsigned int send_retries;    // short writes and EAGAINs left for a later flush
+    unsigned int send_dropped;    // frames dropped because the send buffer was full
+    unsigned int heartbeat_timeouts;  // connections dropped for going silent
+    unsigned int reconnects;      // attempts started by the reconnect scheduler
+    unsigned int resumed_slots;   // synced slots carried over a reconnect to the same server
+} NetworkStats;
+
+// Round trips of acknowledged actions: from network_send_action to the
+// server's action_ack, which it sends once the keystrokes reached tmux
+typedef struct {
+    unsigned int acks;  // acks received since startup
+    int last_ms;        // round trip of the most recent, -1 before the first
+    int server_ms;      // the server's share of it (receive to send-keys done)
+    int p50_ms;         // percentiles over the last LATENCY_WINDOW round trips
+    int p95_ms;
+    int p99_ms;
+} NetworkLatency;
+
+#define LATENCY_WINDOW 64
+
 // Initialize network (call once at startup)
 bool network_init(void);
 
@@ -11,7 +49,7 @@ bool network_init(void);
 void network_exit(void);
 
 // Connect to companion server
-// Returns true if connection initiated (async)
+// Returns true if connection initiated (async); never blocks
 bool network_connect(const char* host, int port);
 
 // Disconnect from server
@@ -20,9 +58,37 @@ void network_disconnect(void);
 // Check if connected
 bool network_is_connected(void);
 
+// Current connection phase (for status display and retry logic)
+NetworkPhase network_get_phase(void);
+
+// For network_poll users (the worker thread schedules its own): whether
+// network_connect should be called now. Call once per frame. A dropped
+// connection is retried at once; failed attempts back off exponentially,
+// with jitter, up to half a minute. Nothing is tried while WiFi is down
+// and an attempt is due the moment it comes back.
+//
+// A reconnect to the same server run resumes: slots already in sync keep
+// their state and seq, and the server only resends the ones that changed.
+bool network_reconnect_due(void);
+
+// Party slots agreed with the server at connect (at most MAX_AGENTS;
+// DEFAULT_AGENT_SLOTS until a server says otherwise)
+int network_get_slot_count(void);
+
 // Poll for incoming messages (call every frame)
-// Updates agents array with received status
-void network_poll(Agent* agents, int* agent_count);
+// Updates agents array with received status.
+// Returns a mask of the slots that changed since the last call (BIT(slot)).
+unsigned int network_poll(Agent* agents, int* agent_count);
+
+// Move the connection to a worker thread that connects to host:port,
+// reconnects on its own and decodes everything off the calling thread.
+// network_poll then only copies finished slot updates into agents and
+// network_send_* queue their message for the worker.
+// Returns false if the thread could not be created (stay on network_poll).
+bool network_start_thread(const char* host, int port);
+
+// Stop the worker thread and disconnect
+void network_stop_thread(void);
 
 // Send action to server
 void network_send_action(const char* agent, const char* action);
@@ -33,7 +99,23 @@ void network_send_command(const char* agent, const char* command);
 // Send config change to server (e.g. auto-edit toggle)
 void network_send_config(const char* agent, bool auto_edit);
 
+// Smoothed round trip of the heartbeat pings in ms, -1 before the first
+// pong. The connection is dropped (and retried) after a few seconds
+// without any data from the server.
+int network_get_rtt(void);
+
+// Round-trip statistics of actions (safe to call from the main thread
+// while the worker runs)
+void network_get_latency(NetworkLatency* out);
+
 // Get server-synced auto-edit state (updated from broadcasts)
 bool network_get_auto_edit(void);
 
+// Decode one complete message payload (JSON text or binary, see codec.h)
+// and apply it to agents. network_poll calls this for every data message.
+void network_handle_message(bool binary, const char* payload, int len, Agent* agents, int* agent_count);
+
+// Get socket counters
+const NetworkStats* network_get_stats(void);
+
 #endif // NETWORK_H
@@ -2,6 +2,7 @@
 #define PROTOCOL_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef enum {
     STATE_IDLE = 0,
@@ -11,23 +12,118 @@ typedef enum {
     STATE_DONE
 } AgentState;
 
+// Text fields of an agent, in AgentText order
+typedef enum {
+    TEXT_NAME = 0,
+    TEXT_MESSAGE,
+    TEXT_PENDING_COMMAND,
+    TEXT_TOOL_TYPE,
+    TEXT_TOOL_DETAIL,
+    TEXT_DESCRIPTION,
+    TEXT_FIELD_COUNT
+} AgentTextField;
+
+// Text of an agent. It is only read when the agent's details are drawn, so
+// it lives apart from the per-frame fields and is allocated for slots that
+// have received any (see agent.h). Each field keeps its length and hash, so
+// an unchanged string is recognized without copying it and the UI can key
+// its text cache on the hash.
 typedef struct {
     char name[32];
-    AgentState state;
-    int progress;  // 0-100, -1 for indeterminate
     char message[128];
     char pending_command[256];
-    int context_percent;  // 0-100
-    bool prompt_visible;
     char prompt_tool_type[64];
     char prompt_tool_detail[1024];
     char prompt_description[256];
-    int slot;                   // 0-3, party position
-    bool spawning;              // true during pokeball animation
-    int spawn_anim_frame;       // animation progress
+    uint32_t hash[TEXT_FIELD_COUNT];    // agent_hash_text of each field
+    uint16_t len[TEXT_FIELD_COUNT];
+} AgentText;
+
+// Per-frame fields of an agent, kept small so a full party stays compact
+typedef struct {
+    AgentText* text;            // NULL until the slot receives text
+    AgentState state;
+    int8_t progress;            // 0-100, -1 for indeterminate
+    uint8_t context_percent;    // 0-100
+    uint8_t slot;               // party position
+    bool prompt_visible;
+    bool spawning;              // spawn succeeded, pokeball animation pending
     bool active;                // true if this slot has a live session
 } Agent;
 
-#define MAX_AGENTS 4
+// Most party slots the client can show. The server may offer fewer; the
+// count agreed at connect is network_get_slot_count().
+#define MAX_AGENTS 16
+
+// Slots assumed when the server doesn't say (servers from before the
+// slot count was negotiated)
+#define DEFAULT_AGENT_SLOTS 4
+
+// Server message types, shared by the JSON ("type") and binary encodings
+typedef enum {
+    MSG_UNKNOWN = 0,
+    MSG_AGENT_STATUS = 1,
+    MSG_SPAWN_RESULT = 2,
+    MSG_AGENT_DELTA = 3,    // changed fields of one slot since seq - 1
+    MSG_SLOT_BATCH = 4,     // several status/delta messages in one frame
+    MSG_ACTION_ACK = 5,     // an action was carried out (latency tracing)
+} MessageType;
+
+// Field keys of the binary encoding (see codec.h)
+// Keep in sync with Field in companion-server/src/codec.ts
+typedef enum {
+    FIELD_AGENT = 1,
+    FIELD_STATE,
+    FIELD_PROGRESS,
+    FIELD_MESSAGE,
+    FIELD_PENDING_COMMAND,
+    FIELD_CONTEXT_PERCENT,
+    FIELD_PROMPT_TOOL_TYPE,
+    FIELD_PROMPT_TOOL_DETAIL,
+    FIELD_PROMPT_DESCRIPTION,
+    FIELD_SLOT,
+    FIELD_ACTIVE,
+    FIELD_AUTO_EDIT,
+    FIELD_SUCCESS,
+    FIELD_ERROR,
+    FIELD_SEQ,
+    FIELD_ENTRY,            // one encoded message inside a MSG_SLOT_BATCH
+    FIELD_TRACE_ID,
+    FIELD_CLIENT_MS,
+    FIELD_SERVER_MS,
+} WireField;
+
+#define FIELD_BIT(f) (1u << (f))
+
+// String view into a message buffer (not NUL-terminated)
+typedef struct {
+    const char* str;
+    int len;
+} WireString;
+
+// One decoded server message, independent of its encoding.
+// Only fields whose FIELD_BIT is set in `present` are meaningful.
+typedef struct {
+    MessageType type;
+    unsigned int present;
+    WireString agent;
+    AgentState state;
+    int progress;
+    WireString message;
+    WireString pending_command;
+    int context_percent;
+    WireString prompt_tool_type;
+    WireString prompt_tool_detail;
+    WireString prompt_description;
+    int slot;
+    bool active;
+    bool auto_edit;
+    bool success;
+    WireString error;
+    int seq;               // per-slot sequence number (agent_status/agent_delta)
+    int trace_id;          // action_ack: id the client gave the action
+    int client_ms;         // action_ack: client clock when it was sent, echoed
+    int server_ms;         // action_ack: receive to send-keys done on the server
+} WireMessage;
 
 #endif // PROTOCOL_H
@@ -0,0 +1,38 @@
+#include "spsc.h"
+#include <stddef.h>
+
+void spsc_init(SpscRing* ring, void* storage, unsigned int slot_size, unsigned int capacity) {
+    ring->slots = storage;
+    ring->slot_size = slot_size;
+    ring->mask = capacity - 1;
+    ring->head = 0;
+    ring->tail = 0;
+}
+
+// Each side reads its own index relaxed and the other side's with acquire,
+// and publishes its own with release, so slot contents are visible before
+// the index that hands them over.
+
+void* spsc_reserve(SpscRing* ring) {
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (tail - head > ring->mask) return NULL;
+    return ring->slots + (tail & ring->mask) * ring->slot_size;
+}
+
+void spsc_commit(SpscRing* ring) {
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+void* spsc_peek(SpscRing* ring) {
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    unsigned int tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (head == tail) return NULL;
+    return ring->slots + (head & ring->mask) * ring->slot_size;
+}
+
+void spsc_release(SpscRing* ring) {
+    unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
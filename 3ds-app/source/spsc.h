@@ -0,0 +1,31 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+// Lock-free single-producer/single-consumer ring of fixed-size slots.
+// One thread reserves and commits, one other thread peeks and releases;
+// neither ever blocks. Slots are used in place, so nothing is copied twice.
+
+typedef struct {
+    unsigned char* slots;
+    unsigned int slot_size;
+    unsigned int mask;      // capacity - 1 (capacity is a power of two)
+    unsigned int head;      // next slot to read, advanced by the consumer
+    unsigned int tail;      // next slot to write, advanced by the producer
+} SpscRing;
+
+// storage must hold slot_size * capacity bytes; capacity a power of two
+void spsc_init(SpscRing* ring, void* storage, unsigned int slot_size, unsigned int capacity);
+
+// Producer: next free slot, or NULL if the ring is full
+void* spsc_reserve(SpscRing* ring);
+
+// Producer: publish the slot returned by spsc_reserve
+void spsc_commit(SpscRing* ring);
+
+// Consumer: oldest published slot, or NULL if the ring is empty
+void* spsc_peek(SpscRing* ring);
+
+// Consumer: hand the slot returned by spsc_peek back to the producer
+void spsc_release(SpscRing* ring);
+
+#endif // SPSC_H
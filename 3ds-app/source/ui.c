@@ -1,6 +1,7 @@
 #include "ui.h"
 #include "config.h"
 #include "creature.h"
+#include "agent.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -25,8 +26,28 @@ static u32 clrLavender;   // #b4befe — highlights, title
 static u32 clrTeal;       // #94e2d5 — healthy context bar
 static u32 clrSapphire;   // #74c7ec — info accent
 
-// Text buffers
+// Text buffers. Labels are parsed once into cacheBuf and kept across frames
+// (see draw_label); textBuf only holds strings too long for the cache and is
+// cleared every frame.
 static C2D_TextBuf textBuf;
+static C2D_TextBuf cacheBuf;
+
+// Text cache — open-addressed table keyed by string content. The parse
+// doesn't depend on the draw scale, so one entry serves every size.
+#define TEXT_CACHE_SIZE    128   // power of two
+#define TEXT_CACHE_LIMIT   96    // flush when this many entries are in use
+#define TEXT_CACHE_GLYPHS  4096
+#define TEXT_KEY_LEN       80
+
+typedef struct {
+    u32 hash;
+    bool used;
+    char key[TEXT_KEY_LEN];
+    C2D_Text text;
+} TextCacheEntry;
+
+static TextCacheEntry text_cache[TEXT_CACHE_SIZE];
+static int text_cache_count = 0;
 
 // Screen dimensions
 #define TOP_WIDTH 400
@@ -65,12 +86,53 @@ static C2D_TextBuf textBuf;
 // Creature slot positions (y varies by mode)
 #define SLOT_START_X  ((BOT_WIDTH - (SLOT_W * SLOT_COUNT + SLOT_GAP * (SLOT_COUNT - 1))) / 2)
 
+// Page indicator in the bottom status bar; tapping it turns the page
+#define PAGE_X        270
+#define PAGE_Y        225
+#define PAGE_W        50
+#define PAGE_H        15
+
+// Party paging. Both screens show SLOT_COUNT agents at a time, so drawing
+// costs the same however many slots the server offers. The page follows
+// the selected agent and can be turned by hand to reach empty slots.
+static int party_slots = DEFAULT_AGENT_SLOTS;
+static int party_page = 0;
+static int party_pages = 1;
+static int party_selected = -1;     // selection the page last followed
+
+// Slots with a creature on each screen as last drawn (ui_visible_slots)
+static u32 top_slots = 0;
+static u32 bottom_slots = 0;
+
+// One past the highest active slot, at most party_slots. The server syncs
+// every slot at connect, so agent_count alone says nothing about which
+// slots have an agent.
+static int party_extent(const Agent* agents, int agent_count) {
+    int extent = agent_count < party_slots ? agent_count : party_slots;
+    while (extent > 0 && !agents[extent - 1].active) extent--;
+    return extent;
+}
+
 static bool auto_edit_enabled = false;
+static int latency_last_ms = -1;
+static int latency_p95_ms = -1;
 
 // Scroll state for tool detail
 static int detail_scroll = 0;
 static int detail_total_lines = 0;
-static char last_tool_detail[1024] = {0};
+static u32 last_tool_detail_hash = 0;
+
+// Tool detail wrapped for one layout, rewrapped only when the text's hash
+// changes
+typedef struct {
+    u32 hash;
+    int len;               // -1 until something is wrapped
+    int nlines;
+    char lines[WRAP_MAX_LINES][WRAP_LINE_LEN];
+} WrappedText;
+
+static WrappedText top_detail = { .len = -1 };
+static WrappedText prompt_detail = { .len = -1 };
 
 void ui_init(void) {
     clrBase     = C2D_Color32(0x1e, 0x1e, 0x2e, 0xFF);
@@ -93,11 +155,99 @@ void ui_init(void) {
     clrTeal     = C2D_Color32(0x94, 0xe2, 0xd5, 0xFF);
     clrSapphire = C2D_Color32(0x74, 0xc7, 0xec, 0xFF);
 
-    textBuf = C2D_TextBufNew(4096);
+    textBuf = C2D_TextBufNew(1024);
+    cacheBuf = C2D_TextBufNew(TEXT_CACHE_GLYPHS);
+
+    if (!creature_init())
+        printf("Creature textures unavailable, drawing per pixel\n");
 }
 
 void ui_exit(void) {
     C2D_TextBufDelete(textBuf);
+    C2D_TextBufDelete(cacheBuf);
+    creature_exit();
+}
+
+// ========== TEXT CACHE ==========
+
+
+// Drop every entry. Text already drawn this frame has been submitted, so
+// clearing the glyph buffer underneath it is safe.
+static void text_cache_flush(void) {
+    memset(text_cache, 0, sizeof(text_cache));
+    text_cache_count = 0;
+    C2D_TextBufClear(cacheBuf);
+}
+
+// Parse str into buf. Returns false if the buffer ran out of glyphs.
+static bool parse_text(C2D_Text* text, C2D_TextBuf buf, const char* str) {
+    const char* end = C2D_TextParse(text, buf, str);
+    C2D_TextOptimize(text);
+    return end && *end == '\0';
+}
+
+// Parsed text for str (len bytes, agent_hash_text h), reusing the previous
+// parse while the string is unchanged. Only a new or changed string costs a
+// C2D_TextParse.
+static const C2D_Text* cached_text_hashed(const char* str, size_t len, u32 h) {
+    if (len >= TEXT_KEY_LEN) {
+        static C2D_Text scratch;
+        parse_text(&scratch, textBuf, str);
+        return &scratch;
+    }
+
+    for (;;) {
+        u32 i = h & (TEXT_CACHE_SIZE - 1);
+        while (text_cache[i].used) {
+            TextCacheEntry* e = &text_cache[i];
+            if (e->hash == h && memcmp(e->key, str, len + 1) == 0) return &e->text;
+            i = (i + 1) & (TEXT_CACHE_SIZE - 1);
+        }
+
+        TextCacheEntry* e = &text_cache[i];
+        bool was_empty = text_cache_count == 0;
+        if (text_cache_count < TEXT_CACHE_LIMIT && parse_text(&e->text, cacheBuf, str)) {
+            e->used = true;
+            e->hash = h;
+            memcpy(e->key, str, len + 1);
+            text_cache_count++;
+            return &e->text;
+        }
+        // Out of room — start over. A key always fits an empty buffer, so
+        // this only loops once.
+        text_cache_flush();
+        if (was_empty) return &e->text;
+    }
+}
+
+static const C2D_Text* cached_text(const char* str) {
+    size_t len = strlen(str);
+    return cached_text_hashed(str, len, agent_hash_text(str, len));
+}
+
+static void draw_label(const char* str, float x, float y, float scale, u32 color) {
+    C2D_DrawText(cached_text(str), C2D_WithColor, x, y, 0, scale, scale, color);
+}
+
+// Draw an agent text field, using the hash stored with it as the cache key
+static void draw_field(const AgentText* text, AgentTextField field, float x, float y,
+                       float scale, u32 color) {
+    const C2D_Text* parsed = cached_text_hashed(agent_text_field(text, field),
+                                                text->len[field], text->hash[field]);
+    C2D_DrawText(parsed, C2D_WithColor, x, y, 0, scale, scale, color);
+}
+
+// Tool detail of text wrapped for a layout
+static const WrappedText* wrap_detail(WrappedText* wrap, const AgentText* text,
+                                      float scale, float max_width_px) {
+    u32 hash = text->hash[TEXT_TOOL_DETAIL];
+    int len = text->len[TEXT_TOOL_DETAIL];
+    if (wrap->len != len || wrap->hash != hash) {
+        wrap->nlines = ui_wrap_text(text->prompt_tool_detail, scale, max_width_px, wrap->lines);
+        wrap->hash = hash;
+        wrap->len = len;
+    }
+    return wrap;
 }
 
 static u32 state_to_color(AgentState state) {
@@ -110,6 +260,35 @@ static u32 state_to_color(AgentState state) {
     }
 }
 
+// How strongly a creature sprite is tinted with its state color
+static float state_to_tint(AgentState state) {
+    switch (state) {
+        case STATE_ERROR: return 0.45f;
+        case STATE_DONE:  return 0.2f;
+        default:          return 0.0f;
+    }
+}
+
+// Draw an animation keyframe in the 16x16 box at (x,y). A keyframe tint
+// replaces the state tint while it lasts.
+static void draw_agent_creature(float x, float y, int scale, const AnimKeyframe* key,
+                                AgentState state) {
+    if (!key) return;
+
+    // Keyframe scale is around the center of the box
+    float s = scale * key->scale;
+    float px = x + (CREATURE_W * (scale - s)) / 2.0f + key->dx * scale;
+    float py = y + (CREATURE_SIZE_H * (scale - s)) / 2.0f + key->dy * scale;
+
+    u32 tint = state_to_color(state);
+    float blend = state_to_tint(state);
+    if (key->blend > 0) {
+        tint = key->tint;
+        blend = key->blend;
+    }
+    draw_creature_tinted(px, py, s, creature_get_frame(key->sprite), tint, blend);
+}
+
 static const char* state_to_string(AgentState state) {
     switch (state) {
         case STATE_WORKING: return "Working";
@@ -155,11 +334,8 @@ static void draw_bar(float x, float y, float w, float h, int percent, u32 color)
     draw_border(x, y, w, h, clrSurface2);
 }
 
-#define WRAP_MAX_LINES 20
-#define WRAP_LINE_LEN  80
-
-static int wrap_text(const char* text, float scale, float max_width_px,
-                     char out_lines[WRAP_MAX_LINES][WRAP_LINE_LEN]) {
+int ui_wrap_text(const char* text, float scale, float max_width_px,
+                 char out_lines[WRAP_MAX_LINES][WRAP_LINE_LEN]) {
     float char_width = 13.0f * scale;
     int max_chars = (int)(max_width_px / char_width);
     if (max_chars < 10) max_chars = 10;
@@ -203,10 +379,7 @@ static void draw_state_pill(float x, float y, AgentState state, float scale) {
 
     C2D_DrawRectSolid(x, y, 0, pill_w, pill_h, bg);
 
-    C2D_Text txt;
-    C2D_TextParse(&txt, textBuf, label);
-    C2D_TextOptimize(&txt);
-    C2D_DrawText(&txt, C2D_WithColor, x + 6, y + 2, 0, scale, scale, clrCrust);
+    draw_label(label, x + 6, y + 2, scale, clrCrust);
 }
 
 static u32 context_color(int percent) {
@@ -218,7 +391,7 @@ static u32 context_color(int percent) {
 // Draw a single creature slot (for party lineup)
 static void draw_creature_slot(float x, float y, float w, float h,
                                 int slot_idx, Agent* agent, bool is_selected,
-                                AnimState* anim) {
+                                const AnimKeyframe* key) {
     // Background
     C2D_DrawRectSolid(x, y, 0, w, h, clrMantle);
 
@@ -227,25 +400,17 @@ static void draw_creature_slot(float x, float y, float w, float h,
         draw_border(x, y, w, h, is_selected ? clrMauve : clrSurface1);
 
         // Draw creature centered in slot
-        const CreatureFrame* frame = anim_current_frame(anim);
-        if (frame) {
-            int scale = (h > 60) ? 3 : 2;
-            float cx = x + (w - CREATURE_W * scale) / 2.0f;
-            float cy = y + 2;
-            draw_creature(cx, cy, scale, frame);
-        }
+        int scale = (h > 60) ? 3 : 2;
+        float cx = x + (w - CREATURE_W * scale) / 2.0f;
+        float cy = y + 2;
+        draw_agent_creature(cx, cy, scale, key, agent->state);
 
         // Name label below creature
-        C2D_Text txtName;
         char nameBuf[16];
-        snprintf(nameBuf, sizeof(nameBuf), "%.10s", agent->name);
-        C2D_TextParse(&txtName, textBuf, nameBuf);
-        C2D_TextOptimize(&txtName);
+        snprintf(nameBuf, sizeof(nameBuf), "%.10s", agent_text(agent)->name);
         float nameScale = 0.35f;
         float nameW = strlen(nameBuf) * 13.0f * nameScale;
-        C2D_DrawText(&txtName, C2D_WithColor,
-                     x + (w - nameW) / 2.0f, y + h - 14, 0,
-                     nameScale, nameScale, clrText);
+        draw_label(nameBuf, x + (w - nameW) / 2.0f, y + h - 14, nameScale, clrText);
 
         // State indicator dot
         u32 dotColor = state_to_color(agent->state);
@@ -254,85 +419,85 @@ static void draw_creature_slot(float x, float y, float w, float h,
         // Empty slot — dashed border with "+" label
         draw_dashed_border(x, y, w, h, clrSurface1);
 
-        C2D_Text txtPlus;
-        C2D_TextParse(&txtPlus, textBuf, "+");
-        C2D_TextOptimize(&txtPlus);
-        C2D_DrawText(&txtPlus, C2D_WithColor,
-                     x + w / 2 - 5, y + h / 2 - 10, 0,
-                     0.7f, 0.7f, clrOverlay0);
+        draw_label("+", x + w / 2 - 5, y + h / 2 - 10, 0.7f, clrOverlay0);
+    }
+}
+
+// Draw the current page of the party lineup. Slots past the server's
+// count are left blank.
+static void draw_party_page(Agent* agents, int agent_count, int selected, float slot_h,
+                            const AnimBank* anims) {
+    int first = party_page * SLOT_COUNT;
+    for (int i = 0; i < SLOT_COUNT && first + i < party_slots; i++) {
+        int idx = first + i;
+        float sx = SLOT_START_X + i * (SLOT_W + SLOT_GAP);
+        Agent* a = (idx < agent_count) ? &agents[idx] : NULL;
+        if (a && a->active) bottom_slots |= BIT(idx);
+        draw_creature_slot(sx, 0, SLOT_W, slot_h, idx, a, (idx == selected),
+                          anim_bank_key(anims, idx));
     }
 }
 
 // ========== TOP SCREEN ==========
 
+// Action round trips (SHOW_LATENCY), in the title bar of either layout
+static void draw_latency(float x, float y) {
+    if (latency_last_ms < 0) return;
+    char rttBuf[32];
+    snprintf(rttBuf, sizeof(rttBuf), "%dms p95 %d", latency_last_ms, latency_p95_ms);
+    draw_label(rttBuf, x, y, 0.4f, clrSubtext1);
+}
+
 void ui_render_top(C3D_RenderTarget* target, Agent* agents, int agent_count,
-                   int selected, bool connected, AnimState* anims) {
+                   int selected, bool connected, const AnimBank* anims) {
     C2D_TargetClear(target, clrBase);
     C2D_SceneBegin(target);
     C2D_TextBufClear(textBuf);
 
-    if (agent_count <= 1) {
+    int extent = party_extent(agents, agent_count);
+    top_slots = 0;
+    if (extent <= 1) {
         // === Expanded single-agent layout ===
-        Agent* agent = (agent_count > 0) ? &agents[0] : NULL;
+        Agent* agent = (extent > 0) ? &agents[0] : NULL;
 
         // Title bar (y=0, 24px)
         C2D_DrawRectSolid(0, 0, 0, TOP_WIDTH, 24, clrCrust);
-        C2D_Text txtTitle;
-        C2D_TextParse(&txtTitle, textBuf, "rAI3DS");
-        C2D_TextOptimize(&txtTitle);
-        C2D_DrawText(&txtTitle, C2D_WithColor, 10, 3, 0, 0.55f, 0.55f, clrLavender);
+        draw_label("rAI3DS", 10, 3, 0.55f, clrLavender);
 
-        C2D_Text txtVer;
-        C2D_TextParse(&txtVer, textBuf, "v0.2.0");
-        C2D_TextOptimize(&txtVer);
-        C2D_DrawText(&txtVer, C2D_WithColor, 350, 5, 0, 0.4f, 0.4f, clrOverlay0);
+        draw_label("v0.2.0", 350, 5, 0.4f, clrOverlay0);
+        draw_latency(250, 5);
 
         C2D_DrawRectSolid(0, 24, 0, TOP_WIDTH, 1, clrSurface1);
 
         if (!agent) return;
+        const AgentText* text = agent_text(agent);
+        top_slots = BIT(0);
 
         // Agent header with creature (y=28, 50px)
         C2D_DrawRectSolid(0, 28, 0, TOP_WIDTH, 50, clrMantle);
 
         // Draw creature in header area
-        if (anims) {
-            const CreatureFrame* frame = anim_current_frame(&anims[0]);
-            if (frame) {
-                draw_creature(15, 30, 3, frame);  // scale 3 = 48x48
-            }
-        }
+        draw_agent_creature(15, 30, 3, anim_bank_key(anims, 0), agent->state);  // scale 3 = 48x48
 
         // Agent name (right of creature)
-        C2D_Text txtName;
-        C2D_TextParse(&txtName, textBuf, agent->name);
-        C2D_TextOptimize(&txtName);
-        C2D_DrawText(&txtName, C2D_WithColor, 70, 36, 0, 0.7f, 0.7f, clrText);
+        draw_field(text, TEXT_NAME, 70, 36, 0.7f, clrText);
 
         // State pill
         draw_state_pill(310, 38, agent->state, 0.5f);
 
         // Context section (y=85)
-        C2D_Text txtCtxLabel;
-        C2D_TextParse(&txtCtxLabel, textBuf, "Context Window");
-        C2D_TextOptimize(&txtCtxLabel);
-        C2D_DrawText(&txtCtxLabel, C2D_WithColor, 40, 85, 0, 0.45f, 0.45f, clrSubtext0);
+        draw_label("Context Window", 40, 85, 0.45f, clrSubtext0);
 
         draw_bar(40, 104, 290, 16, agent->context_percent, context_color(agent->context_percent));
 
         char pctBuf[8];
         snprintf(pctBuf, sizeof(pctBuf), "%d%%", agent->context_percent);
-        C2D_Text txtPct;
-        C2D_TextParse(&txtPct, textBuf, pctBuf);
-        C2D_TextOptimize(&txtPct);
-        C2D_DrawText(&txtPct, C2D_WithColor, 340, 105, 0, 0.45f, 0.45f, clrText);
+        draw_label(pctBuf, 340, 105, 0.45f, clrText);
 
         char tokenBuf[48];
         int tokens_k = (agent->context_percent * 200) / 100;
         snprintf(tokenBuf, sizeof(tokenBuf), "%dk / 200k tokens", tokens_k);
-        C2D_Text txtTokens;
-        C2D_TextParse(&txtTokens, textBuf, tokenBuf);
-        C2D_TextOptimize(&txtTokens);
-        C2D_DrawText(&txtTokens, C2D_WithColor, 40, 125, 0, 0.4f, 0.4f, clrOverlay0);
+        draw_label(tokenBuf, 40, 125, 0.4f, clrOverlay0);
 
         C2D_DrawRectSolid(10, 145, 0, TOP_WIDTH - 20, 1, clrSurface1);
 
@@ -341,54 +506,34 @@ void ui_render_top(C3D_RenderTarget* target, Agent* agents, int agent_count,
         draw_border(10, 148, TOP_WIDTH - 20, 70, clrSurface1);
 
         // Reset scroll when tool detail changes
-        if (strcmp(agent->prompt_tool_detail, last_tool_detail) != 0) {
-            strncpy(last_tool_detail, agent->prompt_tool_detail, sizeof(last_tool_detail) - 1);
-            last_tool_detail[sizeof(last_tool_detail) - 1] = '\0';
+        if (text->hash[TEXT_TOOL_DETAIL] != last_tool_detail_hash) {
+            last_tool_detail_hash = text->hash[TEXT_TOOL_DETAIL];
             detail_scroll = 0;
         }
 
-        if (agent->prompt_tool_type[0] != '\0') {
-            C2D_Text txtToolLabel;
-            C2D_TextParse(&txtToolLabel, textBuf, "Current Tool");
-            C2D_TextOptimize(&txtToolLabel);
-            C2D_DrawText(&txtToolLabel, C2D_WithColor, 20, 151, 0, 0.4f, 0.4f, clrSubtext0);
-
-            C2D_Text txtToolType;
-            C2D_TextParse(&txtToolType, textBuf, agent->prompt_tool_type);
-            C2D_TextOptimize(&txtToolType);
-            C2D_DrawText(&txtToolType, C2D_WithColor, 20, 163, 0, 0.55f, 0.55f, clrPeach);
-
-            if (agent->prompt_tool_detail[0] != '\0') {
-                char lines[WRAP_MAX_LINES][WRAP_LINE_LEN];
-                memset(lines, 0, sizeof(lines));
-                int nlines = wrap_text(agent->prompt_tool_detail, 0.43f, TOP_WIDTH - 50, lines);
+        if (text->prompt_tool_type[0] != '\0') {
+            draw_label("Current Tool", 20, 151, 0.4f, clrSubtext0);
+
+            draw_field(text, TEXT_TOOL_TYPE, 20, 163, 0.55f, clrPeach);
+
+            if (text->prompt_tool_detail[0] != '\0') {
+                const WrappedText* wrap = wrap_detail(&top_detail, text, 0.43f, TOP_WIDTH - 50);
+                int nlines = wrap->nlines;
                 detail_total_lines = nlines;
                 int visible = 3;
                 for (int l = 0; l < visible && (l + detail_scroll) < nlines; l++) {
-                    C2D_Text txtLine;
-                    C2D_TextParse(&txtLine, textBuf, lines[l + detail_scroll]);
-                    C2D_TextOptimize(&txtLine);
-                    C2D_DrawText(&txtLine, C2D_WithColor, 20, 179 + l * 13, 0, 0.43f, 0.43f, clrText);
+                    draw_label(wrap->lines[l + detail_scroll], 20, 179 + l * 13, 0.43f, clrText);
                 }
                 if (detail_scroll + visible < nlines) {
-                    C2D_Text txtMore;
-                    C2D_TextParse(&txtMore, textBuf, "...");
-                    C2D_TextOptimize(&txtMore);
-                    C2D_DrawText(&txtMore, C2D_WithColor, 370, 204, 0, 0.4f, 0.4f, clrOverlay0);
+                    draw_label("...", 370, 204, 0.4f, clrOverlay0);
                 }
             }
         } else {
-            C2D_Text txtToolLabel;
-            C2D_TextParse(&txtToolLabel, textBuf, "Activity");
-            C2D_TextOptimize(&txtToolLabel);
-            C2D_DrawText(&txtToolLabel, C2D_WithColor, 20, 151, 0, 0.4f, 0.4f, clrSubtext0);
+            draw_label("Activity", 20, 151, 0.4f, clrSubtext0);
 
-            C2D_Text txtState;
             char stateBuf[32];
             snprintf(stateBuf, sizeof(stateBuf), "%s...", state_to_string(agent->state));
-            C2D_TextParse(&txtState, textBuf, stateBuf);
-            C2D_TextOptimize(&txtState);
-            C2D_DrawText(&txtState, C2D_WithColor, 20, 170, 0, 0.55f, 0.55f, state_to_color(agent->state));
+            draw_label(stateBuf, 20, 170, 0.55f, state_to_color(agent->state));
         }
 
         // Footer bar
@@ -396,73 +541,52 @@ void ui_render_top(C3D_RenderTarget* target, Agent* agents, int agent_count,
 
         if (connected) {
             C2D_DrawRectSolid(12, 227, 0, 6, 6, clrGreen);
-            C2D_Text txtConn;
-            C2D_TextParse(&txtConn, textBuf, "Connected");
-            C2D_TextOptimize(&txtConn);
-            C2D_DrawText(&txtConn, C2D_WithColor, 22, 223, 0, 0.4f, 0.4f, clrSubtext0);
+            draw_label("Connected", 22, 223, 0.4f, clrSubtext0);
         } else {
             C2D_DrawRectSolid(12, 227, 0, 6, 6, clrRed);
-            C2D_Text txtConn;
-            C2D_TextParse(&txtConn, textBuf, "Disconnected");
-            C2D_TextOptimize(&txtConn);
-            C2D_DrawText(&txtConn, C2D_WithColor, 22, 223, 0, 0.4f, 0.4f, clrSubtext0);
+            draw_label("Disconnected", 22, 223, 0.4f, clrSubtext0);
         }
 
     } else {
         // === Multi-agent compact rows with creatures ===
+        // One page of rows, the one holding the selected agent
         float row_height = 55.0f;
         float start_y = 10.0f;
+        int first = (selected / SLOT_COUNT) * SLOT_COUNT;
 
-        for (int i = 0; i < agent_count && i < MAX_AGENTS; i++) {
+        for (int i = first; i < extent && i < first + SLOT_COUNT; i++) {
             Agent* agent = &agents[i];
-            float y = start_y + (i * row_height);
+            if (!agent->active) continue;  // rows stay at their slot's place
+            top_slots |= BIT(i);
+            const AgentText* text = agent_text(agent);
+            float y = start_y + ((i - first) * row_height);
 
             if (i == selected) {
                 C2D_DrawRectSolid(0, y, 0, TOP_WIDTH, row_height - 5, clrMantle);
             }
 
             // Small creature on the left
-            if (anims) {
-                const CreatureFrame* frame = anim_current_frame(&anims[i]);
-                if (frame) {
-                    draw_creature(5, y + 3, 2, frame);  // scale 2 = 32x32
-                }
-            }
+            draw_agent_creature(5, y + 3, 2, anim_bank_key(anims, i), agent->state);  // scale 2 = 32x32
 
-            C2D_Text txtName;
-            C2D_TextParse(&txtName, textBuf, agent->name);
-            C2D_TextOptimize(&txtName);
-            C2D_DrawText(&txtName, C2D_WithColor, 42, y + 5, 0, 0.6f, 0.6f, clrText);
+            draw_field(text, TEXT_NAME, 42, y + 5, 0.6f, clrText);
 
-            C2D_Text txtState;
-            C2D_TextParse(&txtState, textBuf, state_to_string(agent->state));
-            C2D_TextOptimize(&txtState);
-            C2D_DrawText(&txtState, C2D_WithColor, 320, y + 5, 0, 0.5f, 0.5f, state_to_color(agent->state));
+            draw_label(state_to_string(agent->state), 320, y + 5, 0.5f, state_to_color(agent->state));
 
             char ctxLabel[32];
             snprintf(ctxLabel, sizeof(ctxLabel), "Context: %d%%", agent->context_percent);
-            C2D_Text txtCtx;
-            C2D_TextParse(&txtCtx, textBuf, ctxLabel);
-            C2D_TextOptimize(&txtCtx);
-            C2D_DrawText(&txtCtx, C2D_WithColor, 42, y + 22, 0, 0.4f, 0.4f, clrSubtext0);
+            draw_label(ctxLabel, 42, y + 22, 0.4f, clrSubtext0);
             draw_bar(130, y + 23, 180, 10, agent->context_percent, context_color(agent->context_percent));
 
-            if (agent->prompt_tool_type[0] != '\0') {
-                C2D_Text txtTool;
+            if (text->prompt_tool_type[0] != '\0') {
                 char toolBuf[80];
-                if (agent->prompt_tool_detail[0] != '\0') {
-                    snprintf(toolBuf, sizeof(toolBuf), "%.30s: %.40s", agent->prompt_tool_type, agent->prompt_tool_detail);
+                if (text->prompt_tool_detail[0] != '\0') {
+                    snprintf(toolBuf, sizeof(toolBuf), "%.30s: %.40s", text->prompt_tool_type, text->prompt_tool_detail);
                 } else {
-                    snprintf(toolBuf, sizeof(toolBuf), "%.70s", agent->prompt_tool_type);
+                    snprintf(toolBuf, sizeof(toolBuf), "%.70s", text->prompt_tool_type);
                 }
-                C2D_TextParse(&txtTool, textBuf, toolBuf);
-                C2D_TextOptimize(&txtTool);
-                C2D_DrawText(&txtTool, C2D_WithColor, 42, y + 38, 0, 0.4f, 0.4f, clrPeach);
+                draw_label(toolBuf, 42, y + 38, 0.4f, clrPeach);
             } else {
-                C2D_Text txtMsg;
-                C2D_TextParse(&txtMsg, textBuf, state_to_string(agent->state));
-                C2D_TextOptimize(&txtMsg);
-                C2D_DrawText(&txtMsg, C2D_WithColor, 42, y + 40, 0, 0.45f, 0.45f, clrSubtext0);
+                draw_label(state_to_string(agent->state), 42, y + 40, 0.45f, clrSubtext0);
             }
 
             C2D_DrawRectSolid(0, y + row_height - 5, 0, TOP_WIDTH, 1, clrSurface1);
@@ -470,46 +594,61 @@ void ui_render_top(C3D_RenderTarget* target, Agent* agents, int agent_count,
 
         // Title bar at bottom
         C2D_DrawRectSolid(0, TOP_HEIGHT - 20, 0, TOP_WIDTH, 20, clrCrust);
-        C2D_Text txtTitle;
-        C2D_TextParse(&txtTitle, textBuf, "rAI3DS v0.2.0");
-        C2D_TextOptimize(&txtTitle);
-        C2D_DrawText(&txtTitle, C2D_WithColor, 160, TOP_HEIGHT - 17, 0, 0.5f, 0.5f, clrSubtext0);
+        draw_label("rAI3DS v0.2.0", 160, TOP_HEIGHT - 17, 0.5f, clrSubtext0);
+        draw_latency(10, TOP_HEIGHT - 16);
+
+        int pages = (extent + SLOT_COUNT - 1) / SLOT_COUNT;
+        if (pages > 1) {
+            char pageBuf[24];
+            snprintf(pageBuf, sizeof(pageBuf), "%d/%d", first / SLOT_COUNT + 1, pages);
+            draw_label(pageBuf, 360, TOP_HEIGHT - 17, 0.5f, clrOverlay0);
+        }
     }
 }
 
 // ========== BOTTOM SCREEN ==========
 
+static const char* phase_to_string(NetworkPhase phase) {
+    switch (phase) {
+        case NET_RESOLVING:  return "Looking up server...";
+        case NET_CONNECTING: return "Opening connection...";
+        case NET_HANDSHAKE:  return "Waiting for server...";
+        default:             return "No answer, retrying";
+    }
+}
+
 void ui_render_bottom(C3D_RenderTarget* target, Agent* agents, int agent_count,
-                      int selected, bool connected, AnimState* anims) {
+                      int selected, NetworkPhase phase, const AnimBank* anims) {
     C2D_TargetClear(target, clrBase);
     C2D_SceneBegin(target);
     C2D_TextBufClear(textBuf);
 
     Agent* selected_agent = (agent_count > 0 && selected < agent_count) ? &agents[selected] : NULL;
+    const AgentText* selected_text = selected_agent ? agent_text(selected_agent) : NULL;
+
+    // Pages cover the active agents plus the slot after the last of them,
+    // so there is always an empty slot to tap for a spawn
+    int extent = party_extent(agents, agent_count);
+    bottom_slots = 0;
+    int shown = extent < party_slots ? extent + 1 : party_slots;
+    party_pages = (shown + SLOT_COUNT - 1) / SLOT_COUNT;
+    if (selected != party_selected) {
+        party_selected = selected;
+        party_page = selected / SLOT_COUNT;
+    }
+    if (party_page >= party_pages) party_page = party_pages - 1;
 
     // Connection status — disconnected screen
-    if (!connected) {
-        C2D_Text txtDisc;
-        C2D_TextParse(&txtDisc, textBuf, "Connecting...");
-        C2D_TextOptimize(&txtDisc);
-        C2D_DrawText(&txtDisc, C2D_WithColor, 90, 95, 0, 0.8f, 0.8f, clrYellow);
+    if (phase != NET_CONNECTED) {
+        draw_label("Connecting...", 90, 95, 0.8f, clrYellow);
 
         char addrBuf[64];
         snprintf(addrBuf, sizeof(addrBuf), "%s:%d", SERVER_HOST, SERVER_PORT);
-        C2D_Text txtAddr;
-        C2D_TextParse(&txtAddr, textBuf, addrBuf);
-        C2D_TextOptimize(&txtAddr);
-        C2D_DrawText(&txtAddr, C2D_WithColor, 40, 120, 0, 0.5f, 0.5f, clrSubtext0);
-
-        C2D_Text txtWait;
-        C2D_TextParse(&txtWait, textBuf, "First connect may take 30s");
-        C2D_TextOptimize(&txtWait);
-        C2D_DrawText(&txtWait, C2D_WithColor, 55, 145, 0, 0.45f, 0.45f, clrSubtext0);
-
-        C2D_Text txtExit;
-        C2D_TextParse(&txtExit, textBuf, "START or HOME to exit");
-        C2D_TextOptimize(&txtExit);
-        C2D_DrawText(&txtExit, C2D_WithColor, 70, 180, 0, 0.5f, 0.5f, clrSubtext0);
+        draw_label(addrBuf, 40, 120, 0.5f, clrSubtext0);
+
+        draw_label(phase_to_string(phase), 55, 145, 0.45f, clrSubtext0);
+
+        draw_label("START or HOME to exit", 70, 180, 0.5f, clrSubtext0);
         return;
     }
 
@@ -520,44 +659,27 @@ void ui_render_bottom(C3D_RenderTarget* target, Agent* agents, int agent_count,
 
         // Compact party lineup (y=0-53, scale 2 creatures)
         float slot_h = 53;
-        for (int i = 0; i < SLOT_COUNT; i++) {
-            float sx = SLOT_START_X + i * (SLOT_W + SLOT_GAP);
-            Agent* a = (i < agent_count) ? &agents[i] : NULL;
-            draw_creature_slot(sx, 0, SLOT_W, slot_h, i, a, (i == selected),
-                              anims ? &anims[i] : NULL);
-        }
+        draw_party_page(agents, agent_count, selected, slot_h, anims);
 
         // Tool detail card (y=58-118)
         C2D_DrawRectSolid(DETAIL_X, DETAIL_Y, 0, DETAIL_W, DETAIL_H, clrMantle);
         draw_border(DETAIL_X, DETAIL_Y, DETAIL_W, DETAIL_H, clrSurface1);
 
-        if (selected_agent && selected_agent->prompt_tool_type[0] != '\0') {
-            C2D_Text txtToolType;
-            C2D_TextParse(&txtToolType, textBuf, selected_agent->prompt_tool_type);
-            C2D_TextOptimize(&txtToolType);
-            C2D_DrawText(&txtToolType, C2D_WithColor, DETAIL_X + 5, DETAIL_Y + 3, 0, 0.45f, 0.45f, clrPeach);
+        if (selected_text && selected_text->prompt_tool_type[0] != '\0') {
+            draw_field(selected_text, TEXT_TOOL_TYPE, DETAIL_X + 5, DETAIL_Y + 3, 0.45f, clrPeach);
 
             C2D_DrawRectSolid(DETAIL_X + 5, DETAIL_Y + 18, 0, DETAIL_W - 10, 1, clrSurface1);
 
-            if (selected_agent->prompt_tool_detail[0] != '\0') {
-                char lines[WRAP_MAX_LINES][WRAP_LINE_LEN];
-                memset(lines, 0, sizeof(lines));
-                int nlines = wrap_text(selected_agent->prompt_tool_detail, 0.40f, DETAIL_W - 15, lines);
+            if (selected_text->prompt_tool_detail[0] != '\0') {
+                const WrappedText* wrap = wrap_detail(&prompt_detail, selected_text, 0.40f, DETAIL_W - 15);
+                int nlines = wrap->nlines;
                 detail_total_lines = nlines;
                 int visible = 3;
                 for (int l = 0; l < visible && (l + detail_scroll) < nlines; l++) {
-                    C2D_Text txtLine;
-                    C2D_TextParse(&txtLine, textBuf, lines[l + detail_scroll]);
-                    C2D_TextOptimize(&txtLine);
-                    C2D_DrawText(&txtLine, C2D_WithColor, DETAIL_X + 5, DETAIL_Y + 22 + l * 12, 0,
-                                 0.40f, 0.40f, clrText);
+                    draw_label(wrap->lines[l + detail_scroll], DETAIL_X + 5, DETAIL_Y + 22 + l * 12, 0.40f, clrText);
                 }
                 if (detail_scroll + visible < nlines) {
-                    C2D_Text txtMore;
-                    C2D_TextParse(&txtMore, textBuf, "...");
-                    C2D_TextOptimize(&txtMore);
-                    C2D_DrawText(&txtMore, C2D_WithColor, DETAIL_X + DETAIL_W - 20, DETAIL_Y + DETAIL_H - 12, 0,
-                                 0.35f, 0.35f, clrOverlay0);
+                    draw_label("...", DETAIL_X + DETAIL_W - 20, DETAIL_Y + DETAIL_H - 12, 0.35f, clrOverlay0);
                 }
             }
         }
@@ -568,55 +690,32 @@ void ui_render_bottom(C3D_RenderTarget* target, Agent* agents, int agent_count,
         C2D_DrawRectSolid(BTN_YES_X, BTN_Y, 0, BTN_W, BTN_H, yesBg);
         C2D_DrawRectSolid(BTN_YES_X, BTN_Y, 0, BTN_W, 2, clrSurface2);
         C2D_DrawRectSolid(BTN_YES_X, BTN_Y + BTN_H - 2, 0, BTN_W, 2, clrCrust);
-        C2D_Text txtYes;
-        C2D_TextParse(&txtYes, textBuf, "YES");
-        C2D_TextOptimize(&txtYes);
-        C2D_DrawText(&txtYes, C2D_WithColor, BTN_YES_X + 28, BTN_Y + 14, 0, 0.75f, 0.75f, clrCrust);
+        draw_label("YES", BTN_YES_X + 28, BTN_Y + 14, 0.75f, clrCrust);
         // Button hint
-        C2D_Text txtYesHint;
-        C2D_TextParse(&txtYesHint, textBuf, "[A]");
-        C2D_TextOptimize(&txtYesHint);
-        C2D_DrawText(&txtYesHint, C2D_WithColor, BTN_YES_X + 33, BTN_Y + 42, 0, 0.4f, 0.4f, clrCrust);
+        draw_label("[A]", BTN_YES_X + 33, BTN_Y + 42, 0.4f, clrCrust);
 
         // ALWAYS button
         u32 alwaysBg = clrBlue;
         C2D_DrawRectSolid(BTN_ALWAYS_X, BTN_Y, 0, BTN_W, BTN_H, alwaysBg);
         C2D_DrawRectSolid(BTN_ALWAYS_X, BTN_Y, 0, BTN_W, 2, clrSurface2);
         C2D_DrawRectSolid(BTN_ALWAYS_X, BTN_Y + BTN_H - 2, 0, BTN_W, 2, clrCrust);
-        C2D_Text txtAlways;
-        C2D_TextParse(&txtAlways, textBuf, "ALWAYS");
-        C2D_TextOptimize(&txtAlways);
-        C2D_DrawText(&txtAlways, C2D_WithColor, BTN_ALWAYS_X + 13, BTN_Y + 14, 0, 0.7f, 0.7f, clrCrust);
-        C2D_Text txtAlwaysHint;
-        C2D_TextParse(&txtAlwaysHint, textBuf, "[X]");
-        C2D_TextOptimize(&txtAlwaysHint);
-        C2D_DrawText(&txtAlwaysHint, C2D_WithColor, BTN_ALWAYS_X + 33, BTN_Y + 42, 0, 0.4f, 0.4f, clrCrust);
+        draw_label("ALWAYS", BTN_ALWAYS_X + 13, BTN_Y + 14, 0.7f, clrCrust);
+        draw_label("[X]", BTN_ALWAYS_X + 33, BTN_Y + 42, 0.4f, clrCrust);
 
         // NO button
         u32 noBg = clrRed;
         C2D_DrawRectSolid(BTN_NO_X, BTN_Y, 0, BTN_W, BTN_H, noBg);
         C2D_DrawRectSolid(BTN_NO_X, BTN_Y, 0, BTN_W, 2, clrSurface2);
         C2D_DrawRectSolid(BTN_NO_X, BTN_Y + BTN_H - 2, 0, BTN_W, 2, clrCrust);
-        C2D_Text txtNo;
-        C2D_TextParse(&txtNo, textBuf, "NO");
-        C2D_TextOptimize(&txtNo);
-        C2D_DrawText(&txtNo, C2D_WithColor, BTN_NO_X + 33, BTN_Y + 14, 0, 0.75f, 0.75f, clrCrust);
-        C2D_Text txtNoHint;
-        C2D_TextParse(&txtNoHint, textBuf, "[B]");
-        C2D_TextOptimize(&txtNoHint);
-        C2D_DrawText(&txtNoHint, C2D_WithColor, BTN_NO_X + 33, BTN_Y + 42, 0, 0.4f, 0.4f, clrCrust);
+        draw_label("NO", BTN_NO_X + 33, BTN_Y + 14, 0.75f, clrCrust);
+        draw_label("[B]", BTN_NO_X + 33, BTN_Y + 42, 0.4f, clrCrust);
 
     } else {
         // ========== IDLE MODE LAYOUT ==========
 
         // Party lineup (y=0-70, creatures at scale 3)
         float slot_h = 70;
-        for (int i = 0; i < SLOT_COUNT; i++) {
-            float sx = SLOT_START_X + i * (SLOT_W + SLOT_GAP);
-            Agent* a = (i < agent_count) ? &agents[i] : NULL;
-            draw_creature_slot(sx, 0, SLOT_W, slot_h, i, a, (i == selected),
-                              anims ? &anims[i] : NULL);
-        }
+        draw_party_page(agents, agent_count, selected, slot_h, anims);
 
         // Selected creature showcase (y=75-195)
         if (selected_agent) {
@@ -624,58 +723,38 @@ void ui_render_bottom(C3D_RenderTarget* target, Agent* agents, int agent_count,
             draw_border(10, 75, BOT_WIDTH - 20, 120, clrSurface1);
 
             // Large creature (scale 5 = 80x80)
-            if (anims) {
-                const CreatureFrame* frame = anim_current_frame(&anims[selected]);
-                if (frame) {
-                    draw_creature(20, 80, 5, frame);
-                }
-            }
+            draw_agent_creature(20, 80, 5, anim_bank_key(anims, selected), selected_agent->state);
+            bottom_slots |= BIT(selected);
 
             // Info panel right of creature
             float infoX = 110;
 
             // Agent name
-            C2D_Text txtName;
-            C2D_TextParse(&txtName, textBuf, selected_agent->name);
-            C2D_TextOptimize(&txtName);
-            C2D_DrawText(&txtName, C2D_WithColor, infoX, 80, 0, 0.6f, 0.6f, clrText);
+            draw_field(selected_text, TEXT_NAME, infoX, 80, 0.6f, clrText);
 
             // State pill
             draw_state_pill(infoX, 98, selected_agent->state, 0.45f);
 
             // Context bar
-            C2D_Text txtCtx;
-            C2D_TextParse(&txtCtx, textBuf, "Context");
-            C2D_TextOptimize(&txtCtx);
-            C2D_DrawText(&txtCtx, C2D_WithColor, infoX, 118, 0, 0.35f, 0.35f, clrSubtext0);
+            draw_label("Context", infoX, 118, 0.35f, clrSubtext0);
             draw_bar(infoX, 132, 180, 10, selected_agent->context_percent,
                      context_color(selected_agent->context_percent));
 
             // Current tool info
-            if (selected_agent->prompt_tool_type[0] != '\0') {
-                C2D_Text txtTool;
+            if (selected_text->prompt_tool_type[0] != '\0') {
                 char toolBuf[80];
-                snprintf(toolBuf, sizeof(toolBuf), "%.70s", selected_agent->prompt_tool_type);
-                C2D_TextParse(&txtTool, textBuf, toolBuf);
-                C2D_TextOptimize(&txtTool);
-                C2D_DrawText(&txtTool, C2D_WithColor, infoX, 150, 0, 0.4f, 0.4f, clrPeach);
+                snprintf(toolBuf, sizeof(toolBuf), "%.70s", selected_text->prompt_tool_type);
+                draw_label(toolBuf, infoX, 150, 0.4f, clrPeach);
 
-                if (selected_agent->prompt_tool_detail[0] != '\0') {
-                    C2D_Text txtDetail;
+                if (selected_text->prompt_tool_detail[0] != '\0') {
                     char detBuf[80];
-                    snprintf(detBuf, sizeof(detBuf), "%.70s", selected_agent->prompt_tool_detail);
-                    C2D_TextParse(&txtDetail, textBuf, detBuf);
-                    C2D_TextOptimize(&txtDetail);
-                    C2D_DrawText(&txtDetail, C2D_WithColor, infoX, 165, 0, 0.35f, 0.35f, clrText);
+                    snprintf(detBuf, sizeof(detBuf), "%.70s", selected_text->prompt_tool_detail);
+                    draw_label(detBuf, infoX, 165, 0.35f, clrText);
                 }
             } else {
-                C2D_Text txtState;
                 char stateBuf[32];
                 snprintf(stateBuf, sizeof(stateBuf), "%s...", state_to_string(selected_agent->state));
-                C2D_TextParse(&txtState, textBuf, stateBuf);
-                C2D_TextOptimize(&txtState);
-                C2D_DrawText(&txtState, C2D_WithColor, infoX, 150, 0, 0.5f, 0.5f,
-                             state_to_color(selected_agent->state));
+                draw_label(stateBuf, infoX, 150, 0.5f, state_to_color(selected_agent->state));
             }
         }
     }
@@ -685,18 +764,18 @@ void ui_render_bottom(C3D_RenderTarget* target, Agent* agents, int agent_count,
     u32 aeTxt = auto_edit_enabled ? clrCrust : clrSubtext0;
     C2D_DrawRectSolid(AUTO_EDIT_X, AUTO_EDIT_Y, 0, AUTO_EDIT_W, AUTO_EDIT_H, aeColor);
     draw_border(AUTO_EDIT_X, AUTO_EDIT_Y, AUTO_EDIT_W, AUTO_EDIT_H, clrSurface1);
-    C2D_Text txtAutoEdit;
     const char* aeLabel = auto_edit_enabled ? "AUTO-ACCEPT EDITS: ON [Y]" : "AUTO-ACCEPT EDITS: OFF [Y]";
-    C2D_TextParse(&txtAutoEdit, textBuf, aeLabel);
-    C2D_TextOptimize(&txtAutoEdit);
-    C2D_DrawText(&txtAutoEdit, C2D_WithColor, AUTO_EDIT_X + 40, AUTO_EDIT_Y + 5, 0, 0.5f, 0.5f, aeTxt);
+    draw_label(aeLabel, AUTO_EDIT_X + 40, AUTO_EDIT_Y + 5, 0.5f, aeTxt);
 
     // Status bar (y=225-240)
     C2D_DrawRectSolid(0, 225, 0, BOT_WIDTH, 15, clrCrust);
-    C2D_Text txtStatus;
-    C2D_TextParse(&txtStatus, textBuf, "L/R: Switch   A:Yes B:No X:Always Y:Auto");
-    C2D_TextOptimize(&txtStatus);
-    C2D_DrawText(&txtStatus, C2D_WithColor, 10, 227, 0, 0.35f, 0.35f, clrOverlay0);
+    draw_label("L/R: Switch   A:Yes B:No X:Always Y:Auto", 10, 227, 0.35f, clrOverlay0);
+
+    if (party_pages > 1) {
+        char pageBuf[32];
+        snprintf(pageBuf, sizeof(pageBuf), "%d/%d >", party_page + 1, party_pages);
+        draw_label(pageBuf, PAGE_X + 8, PAGE_Y + 2, 0.35f, clrSubtext1);
+    }
 }
 
 // ========== TOUCH ZONES ==========
@@ -728,14 +807,25 @@ int ui_touch_creature_slot(touchPosition touch) {
     float slot_h = 70;
     for (int i = 0; i < SLOT_COUNT; i++) {
         float sx = SLOT_START_X + i * (SLOT_W + SLOT_GAP);
+        int idx = party_page * SLOT_COUNT + i;
         if (touch.px >= sx && touch.px <= sx + SLOT_W &&
             touch.py >= 0 && touch.py <= slot_h) {
-            return i;
+            return idx < party_slots ? idx : -1;
         }
     }
     return -1;
 }
 
+bool ui_touch_party_page(touchPosition touch) {
+    if (party_pages <= 1) return false;
+    if (touch.px < PAGE_X || touch.px > PAGE_X + PAGE_W ||
+        touch.py < PAGE_Y || touch.py > PAGE_Y + PAGE_H) {
+        return false;
+    }
+    party_page = (party_page + 1) % party_pages;
+    return true;
+}
+
 int ui_touch_spawn(touchPosition touch) {
     // Spawn is triggered by tapping any empty slot (handled in main.c)
     // This function is for a dedicated spawn button, which we don't have yet
@@ -746,10 +836,25 @@ void ui_set_auto_edit(bool enabled) {
     auto_edit_enabled = enabled;
 }
 
-void ui_scroll_detail(int direction) {
+void ui_set_latency(int last_ms, int p95_ms) {
+    latency_last_ms = last_ms;
+    latency_p95_ms = p95_ms;
+}
+
+u32 ui_visible_slots(void) {
+    return top_slots | bottom_slots;
+}
+
+void ui_set_party_size(int slots) {
+    party_slots = slots > 0 ? slots : 1;
+}
+
+bool ui_scroll_detail(int direction) {
+    int prev_scroll = detail_scroll;
     detail_scroll += direction;
     if (detail_scroll < 0) detail_scroll = 0;
     int max_scroll = detail_total_lines - 3;
     if (max_scroll < 0) max_scroll = 0;
     if (detail_scroll > max_scroll) detail_scroll = max_scroll;
+    return detail_scroll != prev_scroll;
 }
@@ -4,6 +4,7 @@
 #include <citro2d.h>
 #include "protocol.h"
 #include "animation.h"
+#include "network.h"
 
 // Initialize UI resources
 void ui_init(void);
@@ -13,11 +14,12 @@ void ui_exit(void);
 
 // Render top screen with agent dashboard
 void ui_render_top(C3D_RenderTarget* target, Agent* agents, int agent_count,
-                   int selected, bool connected, AnimState* anims);
+                   int selected, bool connected, const AnimBank* anims);
 
-// Render bottom screen with party lineup and touch controls
+// Render bottom screen with party lineup and touch controls.
+// Until phase reaches NET_CONNECTED it shows connection progress instead.
 void ui_render_bottom(C3D_RenderTarget* target, Agent* agents, int agent_count,
-                      int selected, bool connected, AnimState* anims);
+                      int selected, NetworkPhase phase, const AnimBank* anims);
 
 // Check if touch is in Yes button
 int ui_touch_yes(touchPosition touch);
@@ -31,16 +33,41 @@ int ui_touch_no(touchPosition touch);
 // Check if touch is in Auto-Edit toggle button
 int ui_touch_auto_edit(touchPosition touch);
 
-// Check if touch hit a creature slot (returns 0-3, or -1 if none)
+// Check if touch hit a creature slot on the shown party page
+// (returns the agent slot, or -1 if none)
 int ui_touch_creature_slot(touchPosition touch);
 
+// Check if touch hit the party page indicator; turns to the next page
+// and returns true if so
+bool ui_touch_party_page(touchPosition touch);
+
 // Check if touch hit the spawn "+" button (returns 1 if hit)
 int ui_touch_spawn(touchPosition touch);
 
 // Set auto-edit state for rendering
 void ui_set_auto_edit(bool enabled);
 
+// Set the action round trip shown in the top title bar (SHOW_LATENCY);
+// last_ms < 0 hides it
+void ui_set_latency(int last_ms, int p95_ms);
+
+// Slots whose creature is on either screen as last rendered (BIT(slot)).
+// Animation changes elsewhere don't need a redraw.
+u32 ui_visible_slots(void);
+
+// Set how many party slots there are (network_get_slot_count)
+void ui_set_party_size(int slots);
+
 // Scroll tool detail up/down (direction: -1 = up, +1 = down)
-void ui_scroll_detail(int direction);
+// Returns true if the scroll position moved.
+bool ui_scroll_detail(int direction);
+
+#define WRAP_MAX_LINES 20
+#define WRAP_LINE_LEN  80
+
+// Word-wrap text into fixed-width lines for the given text scale
+// Returns the number of lines written to out_lines
+int ui_wrap_text(const char* text, float scale, float max_width_px,
+                 char out_lines[WRAP_MAX_LINES][WRAP_LINE_LEN]);
 
 #endif // UI_H
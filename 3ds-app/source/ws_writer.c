@@ -0,0 +1,104 @@
+#include "ws_writer.h"
+#include <string.h>
+
+// Masking key, the last four header bytes of every frame
+static const unsigned char mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+
+static inline void put(WsWriter* w, unsigned char c) {
+    int at = WS_WRITER_HEADER + w->len;
+    if (at < w->cap) w->buf[at] = c ^ mask[w->len & 3];
+    w->len++;
+}
+
+void ws_writer_begin(WsWriter* w, unsigned char* buf, int cap, int opcode) {
+    w->buf = buf;
+    w->cap = cap;
+    w->len = 0;
+    w->opcode = opcode;
+}
+
+void ws_writer_bytes(WsWriter* w, const unsigned char* data, int len) {
+    // Mask the whole run in a local loop rather than a put() per byte
+    int at = WS_WRITER_HEADER + w->len;
+    int fit = w->cap - at;
+    if (fit > len) fit = len;
+    unsigned char* out = w->buf + at;
+    int phase = w->len;
+    for (int i = 0; i < fit; i++) {
+        out[i] = data[i] ^ mask[(phase + i) & 3];
+    }
+    w->len += len;
+}
+
+void ws_writer_raw(WsWriter* w, const char* str) {
+    ws_writer_bytes(w, (const unsigned char*)str, (int)strlen(str));
+}
+
+void ws_writer_string(WsWriter* w, const char* str) {
+    static const char hex[] = "0123456789abcdef";
+    put(w, '"');
+    const unsigned char* p = (const unsigned char*)str;
+    for (;;) {
+        // Copy the run up to the next byte that needs escaping in one go
+        const unsigned char* run = p;
+        while (*p >= 0x20 && *p != '"' && *p != '\\') p++;
+        ws_writer_bytes(w, run, (int)(p - run));
+        unsigned char c = *p++;
+        if (c == '\0') break;
+
+        put(w, '\\');
+        switch (c) {
+            case '"':  put(w, '"'); break;
+            case '\\': put(w, '\\'); break;
+            case '\n': put(w, 'n'); break;
+            case '\r': put(w, 'r'); break;
+            case '\t': put(w, 't'); break;
+            case '\b': put(w, 'b'); break;
+            case '\f': put(w, 'f'); break;
+            default:
+                put(w, 'u');
+                put(w, '0');
+                put(w, '0');
+                put(w, hex[c >> 4]);
+                put(w, hex[c & 0xF]);
+                break;
+        }
+    }
+    put(w, '"');
+}
+
+void ws_writer_int(WsWriter* w, int value) {
+    char digits[12];
+    int n = 0;
+    unsigned int v = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    if (value < 0) put(w, '-');
+    while (n > 0) put(w, (unsigned char)digits[--n]);
+}
+
+void ws_writer_bool(WsWriter* w, bool value) {
+    ws_writer_raw(w, value ? "true" : "false");
+}
+
+bool ws_writer_end(WsWriter* w, const unsigned char** frame, int* len) {
+    if (WS_WRITER_HEADER + w->len > w->cap || w->len > WS_WRITER_MAX_PAYLOAD) return false;
+
+    // Mask bit set (required from clients), then the length
+    unsigned char* h = w->buf + WS_WRITER_HEADER - 4;
+    memcpy(h, mask, 4);
+    if (w->len < 126) {
+        *--h = 0x80 | (unsigned char)w->len;
+    } else {
+        *--h = w->len & 0xFF;
+        *--h = (w->len >> 8) & 0xFF;
+        *--h = 0x80 | 126;
+    }
+    *--h = 0x80 | w->opcode;  // FIN + opcode
+
+    *frame = h;
+    *len = (int)(w->buf + WS_WRITER_HEADER + w->len - h);
+    return true;
+}
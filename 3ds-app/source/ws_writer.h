@@ -0,0 +1,45 @@
+#ifndef WS_WRITER_H
+#define WS_WRITER_H
+
+#include <stdbool.h>
+
+// Builds one masked client WebSocket frame in a caller-provided buffer.
+// JSON is written straight into the frame: strings are escaped and every
+// payload byte is masked as it is written, so there is no intermediate
+// copy and nothing is allocated.
+//
+// The length form isn't known until the end, so the payload starts after
+// room for the longest header this writer emits (16-bit length + mask key);
+// ws_writer_end puts the actual header right before the payload.
+
+#define WS_WRITER_HEADER 8
+#define WS_WRITER_MAX_PAYLOAD 0xFFFF
+
+typedef struct {
+    unsigned char* buf;
+    int cap;
+    int len;            // payload bytes written (or needed, after an overflow)
+    int opcode;
+} WsWriter;
+
+// Start a frame in buf. cap includes WS_WRITER_HEADER.
+void ws_writer_begin(WsWriter* w, unsigned char* buf, int cap, int opcode);
+
+// Append bytes as they are (JSON punctuation, keys, literals)
+void ws_writer_raw(WsWriter* w, const char* str);
+void ws_writer_bytes(WsWriter* w, const unsigned char* data, int len);
+
+// Append a quoted JSON string, escaping quotes, backslashes and control
+// characters. Other bytes, UTF-8 included, pass through.
+void ws_writer_string(WsWriter* w, const char* str);
+
+// Append a JSON number or boolean
+void ws_writer_int(WsWriter* w, int value);
+void ws_writer_bool(WsWriter* w, bool value);
+
+// Finish the frame. *frame and *len describe the bytes to send; they lie
+// inside the buffer passed to ws_writer_begin. Returns false if the
+// payload did not fit (w->len then holds the size it needed).
+bool ws_writer_end(WsWriter* w, const unsigned char** frame, int* len);
+
+#endif // WS_WRITER_H
@@ -1,4 +1,5 @@
 import { $ } from "bun";
+import type { ActionTrace } from "../latency";
 
 const DEFAULT_TMUX_SESSION = "claude-raids";
 
@@ -7,10 +8,11 @@ export interface ClaudeAdapter {
   isRunning(): Promise<boolean>;
   start(command?: string): Promise<void>;
   stop(): Promise<void>;
-  sendYes(): Promise<void>;
-  sendAlways(): Promise<void>;
-  sendNo(): Promise<void>;
-  sendEscape(): Promise<void>;
+  // The trace, if given, is marked after each step (see latency.ts)
+  sendYes(trace?: ActionTrace): Promise<void>;
+  sendAlways(trace?: ActionTrace): Promise<void>;
+  sendNo(trace?: ActionTrace): Promise<void>;
+  sendEscape(trace?: ActionTrace): Promise<void>;
   sendInput(text: string): Promise<void>;
 }
 
@@ -55,28 +57,36 @@ export function createClaudeAdapter(tmuxSession: string = DEFAULT_TMUX_SESSION):
       await $`tmux kill-session -t ${tmuxSession}`;
     },
 
-    async sendYes() {
+    async sendYes(trace) {
       if (!await requireRunning("Yes")) return;
+      trace?.mark("requireRunning");
       console.log(`[claude] Sending Yes to ${tmuxSession}`);
       await $`tmux send-keys -t ${tmuxSession} Enter`;
+      trace?.mark("sendKeys");
     },
 
-    async sendAlways() {
+    async sendAlways(trace) {
       if (!await requireRunning("Always")) return;
+      trace?.mark("requireRunning");
       console.log(`[claude] Sending Always to ${tmuxSession}`);
       await $`tmux send-keys -t ${tmuxSession} Down Enter`;
+      trace?.mark("sendKeys");
     },
 
-    async sendNo() {
+    async sendNo(trace) {
       if (!await requireRunning("No")) return;
+      trace?.mark("requireRunning");
       console.log(`[claude] Sending No to ${tmuxSession}`);
       await $`tmux send-keys -t ${tmuxSession} Down Down Enter`;
+      trace?.mark("sendKeys");
     },
 
-    async sendEscape() {
+    async sendEscape(trace) {
       if (!await requireRunning("Escape")) return;
+      trace?.mark("requireRunning");
       console.log(`[claude] Sending Escape to ${tmuxSession}`);
       await $`tmux send-keys -t ${tmuxSession} Escape`;
+      trace?.mark("sendKeys");
     },
 
     async sendInput(text: string) {
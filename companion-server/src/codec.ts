@@ -0,0 +1,161 @@
+import type {
+  AgentState,
+  AgentStatusMessage,
+  AgentDeltaMessage,
+  BatchMessage,
+  SpawnResultMessage,
+  ActionAckMessage,
+} from "./types";
+
+// Compact binary encoding of server → 3DS messages, sent as WebSocket binary
+// frames to clients that negotiate the "raids-bin" subprotocol.
+//
+//   [version:u8] [type:u8] { [key:u8] [len:varint] [value:len bytes] }*
+//
+// Strings are UTF-8, integers little-endian two's complement in 1, 2 or 4
+// bytes, booleans one byte. Mirrors 3ds-app/source/codec.c.
+
+export const BINARY_SUBPROTOCOL = "raids-bin";
+const WIRE_VERSION = 1;
+
+enum MessageType {
+  AgentStatus = 1,
+  SpawnResult = 2,
+  AgentDelta = 3,
+  Batch = 4,
+  ActionAck = 5,
+}
+
+// Keep in sync with WireField in 3ds-app/source/protocol.h
+enum Field {
+  Agent = 1,
+  State,
+  Progress,
+  Message,
+  PendingCommand,
+  ContextPercent,
+  PromptToolType,
+  PromptToolDetail,
+  PromptDescription,
+  Slot,
+  Active,
+  AutoEdit,
+  Success,
+  Error,
+  Seq,
+  Entry, // one encoded message inside a Batch
+  TraceId,
+  ClientMs,
+  ServerMs,
+}
+
+// Same order as AgentState in protocol.h
+const STATE_CODES: Record<AgentState, number> = {
+  idle: 0,
+  working: 1,
+  waiting: 2,
+  error: 3,
+  done: 4,
+};
+
+const textEncoder = new TextEncoder();
+
+class WireWriter {
+  private bytes: number[];
+
+  constructor(type: MessageType) {
+    this.bytes = [WIRE_VERSION, type];
+  }
+
+  private header(key: Field, length: number) {
+    this.bytes.push(key);
+    do {
+      let b = length & 0x7f;
+      length >>>= 7;
+      if (length) b |= 0x80;
+      this.bytes.push(b);
+    } while (length);
+  }
+
+  string(key: Field, value: string | undefined) {
+    if (value === undefined) return;
+    const encoded = textEncoder.encode(value);
+    this.header(key, encoded.length);
+    for (const b of encoded) this.bytes.push(b);
+  }
+
+  int(key: Field, value: number | undefined) {
+    if (value === undefined) return;
+    const n = value | 0;
+    const size = n >= -128 && n <= 127 ? 1 : n >= -32768 && n <= 32767 ? 2 : 4;
+    this.header(key, size);
+    for (let i = 0; i < size; i++) this.bytes.push((n >> (8 * i)) & 0xff);
+  }
+
+  bool(key: Field, value: boolean | undefined) {
+    if (value === undefined) return;
+    this.header(key, 1);
+    this.bytes.push(value ? 1 : 0);
+  }
+
+  raw(key: Field, value: Uint8Array) {
+    this.header(key, value.length);
+    for (const b of value) this.bytes.push(b);
+  }
+
+  finish(): Uint8Array {
+    return Uint8Array.from(this.bytes);
+  }
+}
+
+// Absent (undefined) fields are skipped, so this serves full and delta messages
+function writeStatusFields(w: WireWriter, msg: AgentStatusMessage | AgentDeltaMessage) {
+  w.string(Field.Agent, msg.agent);
+  w.int(Field.State, msg.state === undefined ? undefined : STATE_CODES[msg.state]);
+  w.int(Field.Progress, msg.progress);
+  w.string(Field.Message, msg.message);
+  w.int(Field.ContextPercent, msg.contextPercent);
+  w.string(Field.PromptToolType, msg.promptToolType);
+  w.string(Field.PromptToolDetail, msg.promptToolDetail);
+  w.string(Field.PromptDescription, msg.promptDescription);
+  w.int(Field.Slot, msg.slot);
+  w.bool(Field.Active, msg.active);
+  w.bool(Field.AutoEdit, msg.autoEdit);
+  w.int(Field.Seq, msg.seq);
+}
+
+export function encodeAgentStatus(msg: AgentStatusMessage): Uint8Array {
+  const w = new WireWriter(MessageType.AgentStatus);
+  writeStatusFields(w, msg);
+  return w.finish();
+}
+
+export function encodeAgentDelta(msg: AgentDeltaMessage): Uint8Array {
+  const w = new WireWriter(MessageType.AgentDelta);
+  writeStatusFields(w, msg);
+  return w.finish();
+}
+
+export function encodeBatch(msg: BatchMessage): Uint8Array {
+  const w = new WireWriter(MessageType.Batch);
+  for (const entry of msg.messages) {
+    w.raw(Field.Entry, entry.type === "agent_status" ? encodeAgentStatus(entry) : encodeAgentDelta(entry));
+  }
+  return w.finish();
+}
+
+export function encodeSpawnResult(msg: SpawnResultMessage): Uint8Array {
+  const w = new WireWriter(MessageType.SpawnResult);
+  w.int(Field.Slot, msg.slot);
+  w.bool(Field.Success, msg.success);
+  w.string(Field.Error, msg.error);
+  return w.finish();
+}
+
+export function encodeActionAck(msg: ActionAckMessage): Uint8Array {
+  const w = new WireWriter(MessageType.ActionAck);
+  w.int(Field.TraceId, msg.id);
+  w.int(Field.ClientMs, msg.clientMs);
+  w.int(Field.ServerMs, msg.serverMs);
+  return w.finish();
+}
@@ -0,0 +1,89 @@
+// Latency tracing of 3DS actions, from the WebSocket message arriving to
+// tmux send-keys finishing. Each span keeps its last LATENCY_WINDOW
+// durations for the percentiles served on /latency.
+
+const LATENCY_WINDOW = Number(process.env.RAIDS_LATENCY_WINDOW ?? 256);
+
+// In the order they happen; "total" covers all three
+export const SPANS = ["ws", "requireRunning", "sendKeys", "total"] as const;
+export type SpanName = (typeof SPANS)[number];
+
+export interface Percentiles {
+  count: number;
+  p50: number;
+  p95: number;
+  p99: number;
+}
+
+// One action on its way to tmux. mark() ends the span that began at the
+// previous mark (or at the message arriving).
+export class ActionTrace {
+  readonly spans: Partial<Record<SpanName, number>> = {};
+  private readonly start: number;
+  private last: number;
+
+  constructor(readonly id: number | undefined, readonly action: string, received: number) {
+    this.start = received;
+    this.last = received;
+  }
+
+  mark(span: Exclude<SpanName, "total">) {
+    const now = performance.now();
+    this.spans[span] = now - this.last;
+    this.last = now;
+  }
+
+  // Milliseconds from the message arriving to the last mark
+  get elapsed(): number {
+    return this.last - this.start;
+  }
+
+  // Whether the keystrokes reached tmux
+  get sent(): boolean {
+    return this.spans.sendKeys !== undefined;
+  }
+}
+
+// Ring of recent durations per span
+const windows = new Map(SPANS.map((s): [SpanName, number[]] => [s, []]));
+let recorded = 0;
+
+function push(span: SpanName, ms: number) {
+  const window = windows.get(span)!;
+  if (window.length === LATENCY_WINDOW) window.shift();
+  window.push(ms);
+}
+
+// Add a finished trace to the percentiles and log it
+export function recordTrace(trace: ActionTrace) {
+  const label = `#${trace.id ?? "-"} ${trace.action}`;
+  if (!trace.sent) {
+    console.log(`[trace] ${label}: not sent`);
+    return;
+  }
+  for (const span of SPANS) {
+    const ms = span === "total" ? trace.elapsed : trace.spans[span];
+    if (ms !== undefined) push(span, ms);
+  }
+  recorded++;
+  const parts = SPANS.map((s) => `${s} ${(s === "total" ? trace.elapsed : trace.spans[s] ?? 0).toFixed(1)}ms`);
+  console.log(`[trace] ${label}: ${parts.join(", ")}`);
+}
+
+function percentiles(values: number[]): Percentiles {
+  const sorted = [...values].sort((a, b) => a - b);
+  // Nearest rank
+  const at = (p: number) => {
+    if (sorted.length === 0) return 0;
+    const rank = Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1);
+    return Math.round(sorted[Math.max(0, rank)] * 100) / 100;
+  };
+  return { count: sorted.length, p50: at(50), p95: at(95), p99: at(99) };
+}
+
+// Percentiles in milliseconds of every span over the window
+export function latencySummary() {
+  const spans: Record<string, Percentiles> = {};
+  for (const span of SPANS) spans[span] = percentiles(windows.get(span)!);
+  return { traced: recorded, window: LATENCY_WINDOW, spans };
+}
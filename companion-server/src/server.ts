@@ -3,12 +3,15 @@ import type {
   PostToolHook,
   AgentStatus,
   AgentStatusMessage,
+  AgentDeltaMessage,
   DSMessage,
   SpawnResultMessage,
   SessionStartHook,
   SessionEndHook,
   StopHook,
   UserPromptHook,
+  ServerMessage,
+  ClientData,
 } from "./types";
 import type { ServerWebSocket } from "bun";
 import {
@@ -22,12 +25,34 @@ import {
   linkSession,
   touchSession,
   MAX_SLOTS,
+  DEFAULT_CLIENT_SLOTS,
 } from "./session";
+import {
+  BINARY_SUBPROTOCOL,
+  encodeAgentStatus,
+  encodeAgentDelta,
+  encodeBatch,
+  encodeSpawnResult,
+  encodeActionAck,
+} from "./codec";
+import { ActionTrace, recordTrace, latencySummary } from "./latency";
 import { $ } from "bun";
 
 const PORT = 3333;
 const HOST = "0.0.0.0";
 
+// Slot updates are coalesced for this long (about two frames at the 3DS's
+// 60 fps) and sent together. 0 sends each update immediately.
+const BATCH_WINDOW_MS = Number(process.env.RAIDS_BATCH_MS ?? 33);
+
+// Clients are pinged this often, and dropped after this long without any
+// frame from them (their own heartbeat pings included). A 3DS whose WiFi
+// went away is noticed in seconds instead of when TCP gives up. Only
+// clients that have sent a ping or pong are dropped; older builds never
+// answer pings and stay quiet while idle.
+const HEARTBEAT_MS = Number(process.env.RAIDS_HEARTBEAT_MS ?? 1000);
+const HEARTBEAT_TIMEOUT_MS = Number(process.env.RAIDS_HEARTBEAT_TIMEOUT_MS ?? 3000);
+
 // In-memory state — one per slot
 const agentStates: AgentStatus[] = [];
 for (let i = 0; i < MAX_SLOTS; i++) {
@@ -44,7 +69,7 @@ for (let i = 0; i < MAX_SLOTS; i++) {
 }
 
 // WebSocket clients (Bun native)
-const wsClients = new Set<ServerWebSocket>();
+const wsClients = new Set<ServerWebSocket<ClientData>>();
 
 // Auto-edit state (synced with 3DS)
 let autoEditEnabled = false;
@@ -68,19 +93,98 @@ export function getPendingToolData(slot: number = 0) {
   return pendingToolData.get(slot) ?? null;
 }
 
-function broadcast(data: string) {
+function encodeBinary(message: ServerMessage): Uint8Array {
+  switch (message.type) {
+    case "agent_status": return encodeAgentStatus(message);
+    case "agent_delta":  return encodeAgentDelta(message);
+    case "batch":        return encodeBatch(message);
+    case "spawn_result": return encodeSpawnResult(message);
+    case "action_ack":   return encodeActionAck(message);
+  }
+}
+
+function sendTo(client: ServerWebSocket<ClientData>, message: ServerMessage) {
+  try {
+    client.send(client.data.binary ? encodeBinary(message) : JSON.stringify(message));
+  } catch {
+    wsClients.delete(client);
+  }
+}
+
+// Send to every client in its negotiated encoding, encoding at most once each
+function broadcast(message: ServerMessage) {
+  let json: string | undefined;
+  let binary: Uint8Array | undefined;
   for (const client of wsClients) {
     try {
-      client.send(data);
+      if (client.data.binary) {
+        binary ??= encodeBinary(message);
+        client.send(binary);
+      } else {
+        json ??= JSON.stringify(message);
+        client.send(json);
+      }
     } catch {
       wsClients.delete(client);
     }
   }
 }
 
-function broadcastSlotState(slot: number) {
+// A slot's new full state and, if it was sent before, the delta from that
+interface SlotUpdate {
+  full: AgentStatusMessage;
+  delta?: AgentDeltaMessage;
+}
+
+// Send slot updates to every client in the form it negotiated: deltas or
+// full states, one batch frame or a frame each, binary or JSON, and only the
+// slots it has. Each form is encoded at most once.
+function broadcastUpdates(updates: SlotUpdate[]) {
+  const encoded = new Map<string, (string | Uint8Array)[]>();
+  for (const client of wsClients) {
+    const { binary, delta, batch, slots } = client.data;
+    const key = `${binary}/${delta}/${batch}/${slots}`;
+    let frames = encoded.get(key);
+    if (!frames) {
+      const messages = updates
+        .filter((u) => u.full.slot < slots)
+        .map((u) => (delta && u.delta) || u.full);
+      const grouped: ServerMessage[] =
+        batch && messages.length > 1 ? [{ type: "batch", messages }] : messages;
+      frames = grouped.map((m) => (binary ? encodeBinary(m) : JSON.stringify(m)));
+      encoded.set(key, frames);
+    }
+    try {
+      for (const frame of frames) client.send(frame);
+    } catch {
+      wsClients.delete(client);
+    }
+  }
+}
+
+// Per-slot sequence number and the last full state sent, for deltas
+const slotSeq: number[] = new Array(MAX_SLOTS).fill(0);
+// Identifies this server run. Seqs restart with it, so a reconnecting
+// client may only resume from them if its epoch matches (X-Raids-Epoch).
+const SERVER_EPOCH = 1 + Math.floor(Math.random() * 0x7ffffffe);
+const lastSent: (AgentStatusMessage | undefined)[] = new Array(MAX_SLOTS);
+
+const DELTA_FIELDS = [
+  "agent",
+  "state",
+  "progress",
+  "message",
+  "contextPercent",
+  "promptToolType",
+  "promptToolDetail",
+  "promptDescription",
+  "autoEdit",
+  "active",
+] as const;
+
+function buildSlotMessage(slot: number, seq: number): AgentStatusMessage {
   const state = agentStates[slot];
-  const message: AgentStatusMessage = {
+  return {
     type: "agent_status",
     agent: state.name,
     state: state.state,
@@ -93,8 +197,77 @@ function broadcastSlotState(slot: number) {
     autoEdit: autoEditEnabled,
     slot: state.slot,
     active: state.active,
+    seq,
   };
-  broadcast(JSON.stringify(message));
+}
+
+function diffSlotMessage(prev: AgentStatusMessage, next: AgentStatusMessage): AgentDeltaMessage | null {
+  const delta: Record<string, unknown> = { type: "agent_delta", slot: next.slot, seq: next.seq };
+  let changed = false;
+  for (const key of DELTA_FIELDS) {
+    if (prev[key] !== next[key]) {
+      delta[key] = next[key] ?? "";
+      changed = true;
+    }
+  }
+  return changed ? (delta as AgentDeltaMessage) : null;
+}
+
+// Full state of a slot as last sent to clients
+function currentSlotMessage(slot: number): AgentStatusMessage {
+  return (lastSent[slot] ??= buildSlotMessage(slot, slotSeq[slot]));
+}
+
+// Bump the slot's seq and record its state as sent. Returns null when nothing
+// visible changed since the last update.
+function takeSlotUpdate(slot: number): SlotUpdate | null {
+  const prev = lastSent[slot];
+  const full = buildSlotMessage(slot, slotSeq[slot] + 1);
+  const delta = prev ? diffSlotMessage(prev, full) : null;
+  if (prev && !delta) return null;
+
+  slotSeq[slot] = full.seq;
+  lastSent[slot] = full;
+  return { full, delta: delta ?? undefined };
+}
+
+// Slots changed since the last flush, and the pending flush timer
+const dirtySlots = new Set<number>();
+let flushTimer: ReturnType<typeof setTimeout> | null = null;
+
+// Send one update per dirty slot, in slot order
+function flushSlots() {
+  if (flushTimer) {
+    clearTimeout(flushTimer);
+    flushTimer = null;
+  }
+  const updates: SlotUpdate[] = [];
+  for (const slot of [...dirtySlots].sort((a, b) => a - b)) {
+    const update = takeSlotUpdate(slot);
+    if (update) updates.push(update);
+  }
+  dirtySlots.clear();
+  if (updates.length > 0) broadcastUpdates(updates);
+}
+
+// Send the full state of some slots to one client, in one frame if it can
+function sendSlotsTo(client: ServerWebSocket<ClientData>, slots: number[]) {
+  const messages = slots.map((slot) => currentSlotMessage(slot));
+  if (client.data.batch && messages.length > 1) {
+    sendTo(client, { type: "batch", messages });
+  } else {
+    for (const message of messages) sendTo(client, message);
+  }
+}
+
+// Mark a slot changed; it is sent with any others at the end of the window
+function broadcastSlotState(slot: number) {
+  dirtySlots.add(slot);
+  if (BATCH_WINDOW_MS <= 0) {
+    flushSlots();
+  } else {
+    flushTimer ??= setTimeout(flushSlots, BATCH_WINDOW_MS);
+  }
 }
 
 function broadcastAllSlots() {
@@ -105,7 +278,8 @@ function broadcastAllSlots() {
 
 function broadcastSpawnResult(slot: number, success: boolean, error?: string) {
   const message: SpawnResultMessage = { type: "spawn_result", slot, success, error };
-  broadcast(JSON.stringify(message));
+  flushSlots(); // keep it ordered after slot updates already made
+  broadcast(message);
 }
 
 export function updateState(slot: number, updates: Partial<AgentStatus>) {
@@ -136,12 +310,22 @@ async function doSpawn(slot: number): Promise<void> {
   broadcastSlotState(slot);
 }
 
-// Handle incoming WebSocket messages from 3DS
-async function handleWsMessage(msg: DSMessage) {
+// Handle incoming WebSocket messages from 3DS. received is when the frame
+// arrived (performance.now()), where an action's trace starts.
+async function handleWsMessage(ws: ServerWebSocket<ClientData>, msg: DSMessage, received: number) {
   console.log("[ws] Received:", JSON.stringify(msg));
 
+  if (msg.type === "resync") {
+    // Client missed a delta; resend the full slot state to it alone
+    if (msg.slot >= 0 && msg.slot < ws.data.slots) {
+      flushSlots(); // so the resent state is not overtaken by a pending delta
+      sendSlotsTo(ws, [msg.slot]);
+    }
+    return;
+  }
+
   if (msg.type === "spawn_request") {
-    const slot = msg.slot ?? findFreeSlot();
+    const slot = msg.slot ?? findFreeSlot(ws.data.slots);
     if (slot === undefined) {
       console.log("[ws] No free slots for spawn");
       broadcastSpawnResult(-1, false, "No free slots");
@@ -156,16 +340,28 @@ async function handleWsMessage(msg: DSMessage) {
   const adapter = getAdapterForSlot(targetSlot);
 
   if (msg.type === "action" && adapter) {
+    const trace = new ActionTrace(msg.id, msg.action, received);
+    trace.mark("ws");
     try {
       switch (msg.action) {
-        case "yes":    await adapter.sendYes();    break;
-        case "always": await adapter.sendAlways(); break;
-        case "no":     await adapter.sendNo();     break;
-        case "escape": await adapter.sendEscape(); break;
+        case "yes":    await adapter.sendYes(trace);    break;
+        case "always": await adapter.sendAlways(trace); break;
+        case "no":     await adapter.sendNo(trace);     break;
+        case "escape": await adapter.sendEscape(trace); break;
       }
     } catch (e) {
       console.error("[ws] tmux keystroke error:", e);
     }
+    recordTrace(trace);
+    // Clients that trace their actions get an ack once the keys are in
+    if (trace.sent && msg.id !== undefined) {
+      sendTo(ws, {
+        type: "action_ack",
+        id: msg.id,
+        clientMs: msg.clientMs ?? 0,
+        serverMs: Math.round(trace.elapsed),
+      });
+    }
   } else if (msg.type === "command" && adapter) {
     await adapter.sendInput(msg.command);
   } else if (msg.type === "config") {
@@ -182,6 +378,27 @@ async function handleWsMessage(msg: DSMessage) {
   }
 }
 
+// Ping every client and drop the heartbeating ones that have gone silent.
+// Bun answers the clients' pings itself; every frame either way refreshes
+// lastSeen.
+function heartbeat() {
+  const now = performance.now();
+  for (const client of wsClients) {
+    const silent = now - client.data.lastSeen;
+    if (client.data.heartbeats && silent > HEARTBEAT_TIMEOUT_MS) {
+      console.log(`[ws] 3DS client silent for ${Math.round(silent)}ms, dropping`);
+      wsClients.delete(client);
+      client.terminate();
+      continue;
+    }
+    try {
+      client.ping();
+    } catch {
+      wsClients.delete(client);
+    }
+  }
+}
+
 function extractToolDetail(toolInput: Record<string, unknown>): string {
   const keys = ["command", "file_path", "pattern", "query", "url"] as const;
   for (const key of keys) {
@@ -192,14 +409,47 @@ function extractToolDetail(toolInput: Record<string, unknown>): string {
 }
 
 export function startServer() {
-  const server = Bun.serve({
+  const server = Bun.serve<ClientData>({
     hostname: HOST,
     port: PORT,
 
     async fetch(req, server) {
       // WebSocket upgrade
       if (req.headers.get("upgrade")?.toLowerCase() === "websocket") {
-        if (server.upgrade(req)) {
+        // Clients opt into the binary encoding via Sec-WebSocket-Protocol;
+        // everyone else keeps getting JSON text frames
+        const protocols = req.headers.get("sec-websocket-protocol") ?? "";
+        const binary = protocols.split(",").some((p) => p.trim() === BINARY_SUBPROTOCOL);
+        // Optional features are requested in the query string, e.g. /?features=delta
+        const features = (new URL(req.url).searchParams.get("features") ?? "").split(",");
+        const delta = features.includes("delta");
+        const batch = features.includes("batch");
+        // Party size: the client's ?slots=N capped at ours, echoed back in
+        // X-Raids-Slots so both sides agree
+        const asked = Number(new URL(req.url).searchParams.get("slots") ?? DEFAULT_CLIENT_SLOTS);
+        const slots = Math.max(1, Math.min(MAX_SLOTS, Number.isInteger(asked) ? asked : DEFAULT_CLIENT_SLOTS));
+        // Resume: a client reconnecting to this run lists the seq it last
+        // applied per slot (-1 for none) in ?since=, after ?epoch=
+        const params = new URL(req.url).searchParams;
+        const since =
+          Number(params.get("epoch")) === SERVER_EPOCH
+            ? (params.get("since") ?? "").split(",").map((s) => (s === "" ? -1 : Number(s)))
+            : undefined;
+        const headers: Record<string, string> = {
+          "X-Raids-Slots": String(slots),
+          "X-Raids-Epoch": String(SERVER_EPOCH),
+        };
+        if (binary) headers["Sec-WebSocket-Protocol"] = BINARY_SUBPROTOCOL;
+        const data: ClientData = {
+          binary,
+          delta,
+          batch,
+          slots,
+          since,
+          heartbeats: false,
+          lastSeen: performance.now(),
+        };
+        if (server.upgrade(req, { data, headers })) {
           return undefined;
         }
         return new Response("WebSocket upgrade failed", { status: 400 });
@@ -224,6 +474,11 @@ export function startServer() {
         });
       }
 
+      // Action latency percentiles per span (see latency.ts)
+      if (path === "/latency" && req.method === "GET") {
+        return Response.json(latencySummary());
+      }
+
       // Pre-tool hook
       if (path === "/hook/pre-tool" && req.method === "POST") {
         try {
@@ -342,23 +597,45 @@ export function startServer() {
 
     websocket: {
       open(ws) {
-        console.log("[ws] 3DS client connected");
+        console.log(
+          `[ws] 3DS client connected (${ws.data.binary ? "binary" : "json"}${ws.data.delta ? ", delta" : ""}${ws.data.batch ? ", batch" : ""}, ${ws.data.slots} slots)`
+        );
         wsClients.add(ws);
-        // Send current state of all slots to the new client
-        broadcastAllSlots();
+        // Send current state of the slots to the new client only; the
+        // others are already in sync. A resuming client has the slots
+        // still at the seq it lists; updates pending in the batch window
+        // reach it as deltas from there.
+        const { since } = ws.data;
+        const slots = Array.from({ length: ws.data.slots }, (_, i) => i).filter(
+          (slot) => since?.[slot] !== currentSlotMessage(slot).seq
+        );
+        if (since) console.log(`[ws] Resumed, resending ${slots.length} of ${ws.data.slots} slots`);
+        if (slots.length > 0) sendSlotsTo(ws, slots);
       },
 
       message(ws, data) {
+        const received = performance.now();
+        ws.data.lastSeen = received;
         try {
           const text =
             typeof data === "string" ? data : new TextDecoder().decode(data);
           const msg = JSON.parse(text) as DSMessage;
-          handleWsMessage(msg);
+          handleWsMessage(ws, msg, received);
         } catch (e) {
           console.error("[ws] Invalid message:", e);
         }
       },
 
+      ping(ws) {
+        ws.data.heartbeats = true;
+        ws.data.lastSeen = performance.now();
+      },
+
+      pong(ws) {
+        ws.data.heartbeats = true;
+        ws.data.lastSeen = performance.now();
+      },
+
       close(ws) {
         console.log("[ws] 3DS client disconnected");
         wsClients.delete(ws);
@@ -366,6 +643,8 @@ export function startServer() {
     },
   });
 
+  if (HEARTBEAT_MS > 0) setInterval(heartbeat, HEARTBEAT_MS);
+
   console.log(
     `Server listening on http://${HOST}:${PORT} (HTTP + WebSocket)`
   );
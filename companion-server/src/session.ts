@@ -1,7 +1,26 @@
 import { $ } from "bun";
 import { createClaudeAdapter, type ClaudeAdapter } from "./adapters/claude";
 
-export const MAX_SLOTS = 4;
+// Most slots a 3DS client has room for (MAX_AGENTS in protocol.h)
+const CLIENT_MAX_SLOTS = 16;
+
+// RAIDS_SLOTS, clamped to 1..CLIENT_MAX_SLOTS
+function parseSlotCount(value: string | undefined): number {
+  if (value === undefined) return CLIENT_MAX_SLOTS;
+  const parsed = Number.parseInt(value, 10);
+  const slots = Number.isNaN(parsed) ? CLIENT_MAX_SLOTS : Math.max(1, Math.min(CLIENT_MAX_SLOTS, parsed));
+  if (String(slots) !== value.trim()) {
+    console.warn(`[session] RAIDS_SLOTS=${value} is not a slot count in 1..${CLIENT_MAX_SLOTS}, using ${slots}`);
+  }
+  return slots;
+}
+
+// Party slots this server runs. Each client is offered at most as many as it
+// asks for in the upgrade request (?slots=N, see server.ts).
+export const MAX_SLOTS = parseSlotCount(process.env.RAIDS_SLOTS);
+
+// Slots offered to clients that don't ask (3DS builds from before slots=)
+export const DEFAULT_CLIENT_SLOTS = 4;
 
 export interface ManagedSession {
   slot: number;
@@ -193,10 +212,10 @@ export function getAdapterForSlot(slot: number): ClaudeAdapter | undefined {
 }
 
 /**
- * Find the next available slot (for spawn requests).
+ * Find the next available slot below limit (for spawn requests).
  */
-export function findFreeSlot(): number | undefined {
-  for (let i = 0; i < MAX_SLOTS; i++) {
+export function findFreeSlot(limit: number = MAX_SLOTS): number | undefined {
+  for (let i = 0; i < Math.min(limit, MAX_SLOTS); i++) {
     if (!sessions.has(i)) return i;
   }
   return undefined;
@@ -62,8 +62,14 @@ export interface AgentStatusMessage {
   autoEdit?: boolean;
   slot: number;
   active: boolean;
+  seq: number;            // per-slot sequence number, bumped on every change
 }
 
+// Only the fields that changed since the previous seq for this slot.
+// Cleared prompt strings are sent as "".
+export type AgentDeltaMessage = { type: "agent_delta"; slot: number; seq: number } &
+  Partial<Omit<AgentStatusMessage, "type" | "slot" | "seq">>;
+
 export interface SpawnResultMessage {
   type: "spawn_result";
   slot: number;
@@ -71,12 +77,47 @@ export interface SpawnResultMessage {
   error?: string;
 }
 
+// An action was carried out: its keystrokes reached tmux. Echoes the id
+// and clock the client sent it with, so the client can time the round trip.
+export interface ActionAckMessage {
+  type: "action_ack";
+  id: number;
+  clientMs: number;
+  serverMs: number;      // message received to send-keys done
+}
+
+// Slot updates coalesced over one batching window, applied in order
+export interface BatchMessage {
+  type: "batch";
+  messages: (AgentStatusMessage | AgentDeltaMessage)[];
+}
+
+export type ServerMessage =
+  | AgentStatusMessage
+  | AgentDeltaMessage
+  | BatchMessage
+  | SpawnResultMessage
+  | ActionAckMessage;
+
+// Per-connection WebSocket state
+export interface ClientData {
+  binary: boolean; // negotiated the compact binary encoding (see codec.ts)
+  delta: boolean;  // understands agent_delta messages
+  batch: boolean;  // understands batch messages
+  slots: number;   // party slots this client is sent (0 .. slots - 1)
+  since?: number[]; // seq per slot the client resumed from (see X-Raids-Epoch)
+  heartbeats: boolean; // has sent a ping or pong, so going silent means it's gone
+  lastSeen: number; // performance.now() of the last frame from it (see heartbeat)
+}
+
 // Messages from 3DS
 export interface UserAction {
   type: "action";
   agent: string;
   action: "yes" | "always" | "no" | "escape";
   slot?: number;
+  id?: number;        // trace id, answered with an action_ack
+  clientMs?: number;  // client clock when sent, echoed in the ack
 }
 
 export interface UserCommand {
@@ -97,4 +138,10 @@ export interface SpawnRequest {
   slot: number;
 }
 
-export type DSMessage = UserAction | UserCommand | UserConfig | SpawnRequest;
+// Client missed a delta (sequence gap) and wants the full slot state
+export interface ResyncRequest {
+  type: "resync";
+  slot: number;
+}
+
+export type DSMessage = UserAction | UserCommand | UserConfig | SpawnRequest | ResyncRequest;
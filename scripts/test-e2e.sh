@@ -41,6 +41,10 @@ curl -s -X POST http://localhost:3333/hook/post-tool \
   -H 'Content-Type: application/json' \
   -d '{"tool":"Write"}' | python3 -m json.tool
 
+echo ""
+echo "Testing latency endpoint..."
+curl -s http://localhost:3333/latency | python3 -m json.tool
+
 # Check final state
 echo ""
 echo "Final state:"